@@ -0,0 +1,127 @@
+#include "scheduler.h"
+#include "simd_select.h"
+#include "workload_gen.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+
+// Scheduler benchmark: generates synthetic workloads at sizes from 10^3 up
+// to a limit and times every Scheduler subclass and TaskScheduler algorithm
+// on each, printing one JSON document to stdout.
+//
+//   ./scheduler_bench [max_tasks] [seed]     (default 1000000, 1)
+
+namespace {
+
+long peakRssKb() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+struct BenchRun {
+    std::string workload;
+    std::string scheduler;
+    size_t tasks;
+    size_t decisions;
+    double seconds;
+    long peak_rss_kb;
+};
+
+Scheduler* makeExercise(int i) {
+    switch (i) {
+    case 0: return new FCFSScheduler();
+    case 1: return new SJFScheduler();
+    case 2: return new SRTFScheduler();
+    case 3: return new RRNonPreemptiveScheduler(4);
+    default: return new RoundRobinScheduler(4);
+    }
+}
+
+const char* EXERCISE_NAMES[] = {
+    "FCFSScheduler", "SJFScheduler", "SRTFScheduler",
+    "RRNonPreemptiveScheduler", "RoundRobinScheduler"
+};
+const char* ALGORITHMS[] = { "FCFS", "SJF", "SRTF", "RR", "Priority", "MLFQ", "CFS" };
+const int ALGORITHM_COUNT = sizeof(ALGORITHMS) / sizeof(ALGORITHMS[0]);
+
+double secondsSince(std::chrono::steady_clock::time_point begin) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+void printRun(const BenchRun& r, bool last) {
+    double tasks_per_sec = r.seconds > 0 ? r.tasks / r.seconds : 0;
+    double ns_per_decision = r.decisions > 0 ? r.seconds * 1e9 / r.decisions : 0;
+    std::printf("    {\"workload\": \"%s\", \"scheduler\": \"%s\", \"tasks\": %zu, "
+                "\"decisions\": %zu, \"seconds\": %.6f, \"tasks_per_sec\": %.0f, "
+                "\"ns_per_decision\": %.2f, \"peak_rss_kb\": %ld}%s\n",
+                r.workload.c_str(), r.scheduler.c_str(), r.tasks, r.decisions,
+                r.seconds, tasks_per_sec, ns_per_decision, r.peak_rss_kb,
+                last ? "" : ",");
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    size_t max_tasks = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    uint64_t seed = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1;
+    
+    std::vector<WorkloadSpec> shapes(3);
+    shapes[0].burst = BURST_EXPONENTIAL;
+    shapes[0].priority = PRIORITY_UNIFORM;
+    shapes[1].burst = BURST_BIMODAL;
+    shapes[1].priority = PRIORITY_SKEWED;
+    shapes[2].burst = BURST_PARETO;
+    shapes[2].priority = PRIORITY_UNIFORM;
+    
+    std::vector<BenchRun> runs;
+    TaskStore workload;
+    
+    for (size_t n = 1000; n <= max_tasks; n *= 10) {
+        for (size_t s = 0; s < shapes.size(); s++) {
+            WorkloadSpec spec = shapes[s];
+            spec.tasks = n;
+            spec.seed = seed;
+            generateWorkload(spec, workload);
+            std::string label = describeWorkload(spec);
+            
+            for (int i = 0; i < 5; i++) {
+                std::unique_ptr<Scheduler> scheduler(makeExercise(i));
+                scheduler->useWorkload(workload);
+                
+                std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+                scheduler->schedule();
+                double seconds = secondsSince(begin);
+                
+                BenchRun r = { label, EXERCISE_NAMES[i], n, scheduler->dispatches(),
+                               seconds, peakRssKb() };
+                runs.push_back(r);
+            }
+            
+            for (int i = 0; i < ALGORITHM_COUNT; i++) {
+                TaskScheduler scheduler(ALGORITHMS[i], 4);
+                scheduler.useWorkload(workload);
+                
+                std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+                scheduler.run();
+                double seconds = secondsSince(begin);
+                
+                BenchRun r = { label, std::string("TaskScheduler/") + ALGORITHMS[i], n,
+                               scheduler.dispatches(), seconds, peakRssKb() };
+                runs.push_back(r);
+            }
+        }
+    }
+    
+    std::printf("{\n  \"isa\": \"%s\",\n  \"seed\": %llu,\n  \"runs\": [\n",
+                selectIsa(), static_cast<unsigned long long>(seed));
+    for (size_t i = 0; i < runs.size(); i++) {
+        printRun(runs[i], i + 1 == runs.size());
+    }
+    std::printf("  ]\n}\n");
+    return 0;
+}
@@ -0,0 +1,220 @@
+#include "binary_trace.h"
+#include "mapped_file.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+const char TRACE_MAGIC[8] = { 'L', 'A', 'B', 'T', 'R', 'A', 'C', 'E' };
+
+bool littleEndian() {
+    uint16_t probe = 1;
+    return *reinterpret_cast<const unsigned char*>(&probe) == 1;
+}
+
+size_t padded(size_t bytes) {
+    return (bytes + 7) & ~static_cast<size_t>(7);
+}
+
+// Mapping plus any column that had to be decoded out of it
+struct TraceBacking {
+    std::shared_ptr<MappedFile> file;
+    std::vector<SimTime> arrivals;
+    std::vector<SimTime> bursts;
+};
+
+class TraceWriter {
+private:
+    std::FILE* out;
+    std::string path;
+    
+public:
+    explicit TraceWriter(const std::string& p) : out(std::fopen(p.c_str(), "wb")), path(p) {
+        if (!out) throw std::runtime_error("cannot create " + path);
+        std::setvbuf(out, nullptr, _IOFBF, 1 << 20);
+    }
+    
+    ~TraceWriter() {
+        if (out) std::fclose(out);
+    }
+    
+    void write(const void* data, size_t bytes) {
+        if (bytes && std::fwrite(data, 1, bytes, out) != bytes) {
+            throw std::runtime_error("write failed: " + path);
+        }
+    }
+    
+    void pad(size_t bytes) {
+        static const char zeros[8] = { 0 };
+        write(zeros, padded(bytes) - bytes);
+    }
+    
+    void finish() {
+        int rc = std::fclose(out);
+        out = nullptr;
+        if (rc != 0) throw std::runtime_error("write failed: " + path);
+    }
+};
+
+void appendVarint(std::vector<unsigned char>& out, int64_t value) {
+    uint64_t v = (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    while (v >= 0x80) {
+        out.push_back(static_cast<unsigned char>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<unsigned char>(v));
+}
+
+}
+
+bool isBinaryTrace(const char* data, size_t size) {
+    return size >= sizeof(BinaryTraceHeader) &&
+           std::memcmp(data, TRACE_MAGIC, sizeof(TRACE_MAGIC)) == 0;
+}
+
+void writeBinaryTrace(const std::string& path, const TaskStore& store, bool delta_arrivals) {
+    if (!littleEndian()) {
+        throw std::runtime_error("binary traces require a little-endian host");
+    }
+    
+    size_t n = store.size();
+    BinaryTraceHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, TRACE_MAGIC, sizeof(TRACE_MAGIC));
+    header.version = BINARY_TRACE_VERSION;
+    header.flags = delta_arrivals ? TRACE_DELTA_ARRIVALS : 0;
+    header.task_count = n;
+    
+    for (size_t i = 0; i < n; i++) {
+        SimTime at = store.arrivalTime(i);
+        if (i == 0 || at < header.min_arrival) header.min_arrival = at;
+        if (i == 0 || at > header.max_arrival) header.max_arrival = at;
+    }
+    
+    std::vector<unsigned char> deltas;
+    if (delta_arrivals) {
+        deltas.reserve(n * 2);
+        SimTime prev = 0;
+        for (size_t i = 0; i < n; i++) {
+            appendVarint(deltas, static_cast<int64_t>(store.arrivalTime(i)) - prev);
+            prev = store.arrivalTime(i);
+        }
+        header.arrival_bytes = deltas.size();
+    } else {
+        header.arrival_bytes = n * sizeof(SimTime);
+    }
+    
+    TraceWriter out(path);
+    out.write(&header, sizeof(header));
+    out.write(store.idData(), n * sizeof(int));
+    out.pad(n * sizeof(int));
+    out.write(store.burstData(), n * sizeof(SimTime));
+    out.write(store.priorityData(), n * sizeof(int));
+    out.pad(n * sizeof(int));
+    if (delta_arrivals) {
+        out.write(deltas.data(), deltas.size());
+    } else {
+        out.write(store.arrivalData(), n * sizeof(SimTime));
+    }
+    out.finish();
+}
+
+TraceLoadStats attachBinaryTrace(const std::shared_ptr<MappedFile>& file, TaskStore& store) {
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    
+    const char* data = file->data();
+    size_t size = file->size();
+    if (!isBinaryTrace(data, size)) {
+        throw std::runtime_error("not a binary trace");
+    }
+    if (!littleEndian()) {
+        throw std::runtime_error("binary traces require a little-endian host");
+    }
+    
+    BinaryTraceHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (header.version != 1 && header.version != BINARY_TRACE_VERSION) {
+        throw std::runtime_error("unsupported binary trace version " +
+                                 std::to_string(header.version));
+    }
+    
+    // Version 1 stored bursts and fixed-width arrivals as int32
+    bool narrow = header.version == 1;
+    size_t n = header.task_count;
+    size_t column = padded(n * sizeof(int32_t));
+    size_t time_column = narrow ? column : n * sizeof(SimTime);
+    size_t bursts_at = sizeof(header) + column;
+    size_t priorities_at = bursts_at + time_column;
+    size_t arrivals_at = priorities_at + column;
+    if (n > size || n * sizeof(SimTime) > size || arrivals_at > size ||
+        header.arrival_bytes > size - arrivals_at) {
+        throw std::runtime_error("truncated binary trace");
+    }
+    
+    const int* ids = reinterpret_cast<const int*>(data + sizeof(header));
+    const int* priorities = reinterpret_cast<const int*>(data + priorities_at);
+    
+    std::shared_ptr<TraceBacking> backing = std::make_shared<TraceBacking>();
+    backing->file = file;
+    const SimTime* bursts;
+    const SimTime* arrivals;
+    
+    if (narrow) {
+        const int32_t* narrow_bursts = reinterpret_cast<const int32_t*>(data + bursts_at);
+        backing->bursts.assign(narrow_bursts, narrow_bursts + n);
+        bursts = backing->bursts.data();
+    } else {
+        bursts = reinterpret_cast<const SimTime*>(data + bursts_at);
+    }
+    
+    if (header.flags & TRACE_DELTA_ARRIVALS) {
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(data + arrivals_at);
+        const unsigned char* end = p + header.arrival_bytes;
+        backing->arrivals.reserve(n);
+        int64_t at = 0;
+        for (size_t i = 0; i < n; i++) {
+            uint64_t v = 0;
+            int shift = 0;
+            while (p < end && (*p & 0x80) && shift < 63) {
+                v |= static_cast<uint64_t>(*p++ & 0x7f) << shift;
+                shift += 7;
+            }
+            if (p == end) throw std::runtime_error("truncated arrival column");
+            v |= static_cast<uint64_t>(*p++) << shift;
+            at += static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+            backing->arrivals.push_back(at);
+        }
+        arrivals = backing->arrivals.data();
+    } else if (narrow) {
+        if (header.arrival_bytes < n * sizeof(int32_t)) {
+            throw std::runtime_error("truncated arrival column");
+        }
+        const int32_t* narrow_arrivals = reinterpret_cast<const int32_t*>(data + arrivals_at);
+        backing->arrivals.assign(narrow_arrivals, narrow_arrivals + n);
+        arrivals = backing->arrivals.data();
+    } else {
+        if (header.arrival_bytes < n * sizeof(SimTime)) {
+            throw std::runtime_error("truncated arrival column");
+        }
+        arrivals = reinterpret_cast<const SimTime*>(data + arrivals_at);
+    }
+    
+    // The same range check text traces get, in one pass
+    for (size_t i = 0; i < n; i++) {
+        if (arrivals[i] < 0 || bursts[i] < 0) {
+            throw std::runtime_error("binary trace row " + std::to_string(i + 1) +
+                                     ": negative arrival or burst");
+        }
+    }
+    
+    store.attach(n, ids, arrivals, bursts, priorities, backing);
+    
+    TraceLoadStats stats;
+    stats.tasks = n;
+    stats.bytes = size;
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    return stats;
+}
@@ -0,0 +1,53 @@
+#ifndef BINARY_TRACE_H
+#define BINARY_TRACE_H
+
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include "task_store.h"
+#include "trace_loader.h"
+
+class MappedFile;
+
+// Binary trace layout (version 2, little-endian):
+//
+//   BinaryTraceHeader                          64 bytes
+//   id column        int32[task_count]         padded to 8 bytes
+//   burst column     int64[task_count]
+//   priority column  int32[task_count]         padded to 8 bytes
+//   arrival column   int64[task_count], or arrival_bytes of zigzag varint
+//                    deltas when TRACE_DELTA_ARRIVALS is set
+//
+// The fixed-width columns are used in place from the mapping; only a
+// delta-encoded arrival column has to be decoded. Version 1 traces, with
+// 32-bit burst and arrival columns, are still read by widening those
+// columns into memory.
+const uint32_t BINARY_TRACE_VERSION = 2;
+const uint32_t TRACE_DELTA_ARRIVALS = 1;
+
+struct BinaryTraceHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+    uint64_t task_count;
+    int64_t min_arrival;
+    int64_t max_arrival;
+    uint64_t arrival_bytes;
+    uint64_t reserved[2];
+};
+
+// True if the buffer starts with a binary trace header
+bool isBinaryTrace(const char* data, size_t size);
+
+// Writes the store's input columns as a binary trace.
+// Throws std::runtime_error if the file can't be written.
+void writeBinaryTrace(const std::string& path, const TaskStore& store, bool delta_arrivals);
+
+// Points the store at the columns of a mapped binary trace, replacing its
+// contents. The store keeps the mapping alive for as long as it uses it.
+// Throws std::runtime_error if the file is truncated, not a version 1 or 2
+// trace, or has a negative arrival or burst.
+TraceLoadStats attachBinaryTrace(const std::shared_ptr<MappedFile>& file, TaskStore& store);
+
+#endif
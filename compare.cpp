@@ -0,0 +1,114 @@
+#include "compare.h"
+#include "simulation.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+std::vector<CompareConfig> allPolicies(const std::vector<SimTime>& rr_quanta) {
+    std::vector<CompareConfig> configs;
+    configs.push_back(CompareConfig("FCFS"));
+    configs.push_back(CompareConfig("SJF"));
+    configs.push_back(CompareConfig("SRTF"));
+    configs.push_back(CompareConfig("Priority"));
+    SimTime base = rr_quanta.empty() ? 4 : rr_quanta[0];
+    configs.push_back(CompareConfig("MLFQ", base));
+    configs.push_back(CompareConfig("CFS", base));
+    for (size_t i = 0; i < rr_quanta.size(); i++) {
+        configs.push_back(CompareConfig("RR", rr_quanta[i]));
+    }
+    return configs;
+}
+
+namespace {
+
+// Runs one configuration with the loop specialised for its policy
+struct RunConfig {
+    EventSimulator& sim;
+    template <class Queue> void operator()(Queue& queue) { sim.run(queue); }
+};
+
+}
+
+std::vector<CompareResult> compareSchedulers(const TaskStore& workload,
+                                             const std::vector<CompareConfig>& configs,
+                                             unsigned threads) {
+    for (size_t i = 0; i < configs.size(); i++) {
+        if (!makeReadyQueue(configs[i].algorithm, configs[i].quantum)) {
+            throw std::invalid_argument("unknown algorithm: " + configs[i].algorithm);
+        }
+    }
+    
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min<size_t>(threads, std::max<size_t>(configs.size(), 1));
+    
+    std::vector<CompareResult> results(configs.size());
+    std::vector<int> order = arrivalOrder(workload);
+    std::atomic<size_t> next(0);
+    
+    auto worker = [&]() {
+        // Per-worker scratch, reused for every configuration it takes
+        TaskStore scratch = workload.view();
+        EventSimulator sim(scratch);
+        sim.useArrivalOrder(order);
+        ReadyQueueSet queues;
+        StreamingMetrics stream;
+        
+        for (size_t i = next++; i < configs.size(); i = next++) {
+            RunConfig run = { sim };
+            queues.configure(configs[i].algorithm, configs[i].quantum);
+            
+            std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+            visitReadyQueue(queues, configs[i].algorithm, run);
+            double seconds = std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - begin).count();
+            
+            stream.clear();
+            stream.record(scratch);
+            results[i].config = configs[i];
+            results[i].metrics = stream.summary();
+            results[i].seconds = seconds;
+        }
+    };
+    
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; t++) pool.push_back(std::thread(worker));
+    worker();
+    for (size_t t = 0; t < pool.size(); t++) pool[t].join();
+    
+    return results;
+}
+
+void printComparison(const std::vector<CompareResult>& results) {
+    std::cout << "\n=== Scheduler Comparison ("
+              << (results.empty() ? 0 : results[0].metrics.tasks) << " tasks) ===\n";
+    std::cout << "Algorithm\t\tQuantum\tAvg Waiting\tAvg Turnaround\tThroughput\tCPU Util\tSim Time (s)\n";
+    std::cout << "----------------------------------------------------------------------------------------------------\n";
+    
+    std::ios::fmtflags flags = std::cout.flags();
+    std::streamsize precision = std::cout.precision();
+    std::cout << std::fixed;
+    
+    for (size_t i = 0; i < results.size(); i++) {
+        const CompareResult& r = results[i];
+        std::cout << std::left << std::setw(16) << r.config.algorithm << std::right;
+        if (r.config.algorithm == "RR" || r.config.algorithm == "MLFQ" ||
+            r.config.algorithm == "CFS") {
+            std::cout << r.config.quantum;
+        } else {
+            std::cout << "-";
+        }
+        std::cout << std::setprecision(2)
+                  << "\t" << r.metrics.avg_waiting
+                  << "\t\t" << r.metrics.avg_turnaround
+                  << "\t\t" << r.metrics.throughput
+                  << "\t\t" << r.metrics.cpu_utilization << "%"
+                  << "\t\t" << std::setprecision(4) << r.seconds << "\n";
+    }
+    
+    std::cout.flags(flags);
+    std::cout.precision(precision);
+}
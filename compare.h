@@ -0,0 +1,44 @@
+#ifndef COMPARE_H
+#define COMPARE_H
+
+#include <string>
+#include <vector>
+#include "task_store.h"
+#include "metrics.h"
+
+// One (algorithm, quantum) configuration to compare
+struct CompareConfig {
+    std::string algorithm;
+    SimTime quantum;
+    
+    CompareConfig(const std::string& algo, SimTime q = 4)
+        : algorithm(algo), quantum(q) {}
+};
+
+struct CompareResult {
+    CompareConfig config;
+    ScheduleMetrics metrics;
+    double seconds;   // wall time of the simulation itself
+    
+    CompareResult() : config(""), seconds(0) {}
+};
+
+// Every TaskScheduler algorithm once (MLFQ and CFS based on the first
+// quantum), plus RR at each of the given quanta
+std::vector<CompareConfig> allPolicies(const std::vector<SimTime>& rr_quanta);
+
+// Runs every configuration over one shared, read-only workload on a pool of
+// `threads` workers (0 = one per hardware thread). The arrival order is
+// sorted once and shared; each worker keeps its own output columns and
+// simulator, reused across the configurations it picks up.
+// Results come back in configuration order.
+// Throws std::invalid_argument for an unknown algorithm or a quantum its
+// policy rejects.
+std::vector<CompareResult> compareSchedulers(const TaskStore& workload,
+                                             const std::vector<CompareConfig>& configs,
+                                             unsigned threads = 0);
+
+// Prints the results as one table in the printMetrics() units
+void printComparison(const std::vector<CompareResult>& results);
+
+#endif
@@ -0,0 +1,56 @@
+#include "counters.h"
+#include <cstring>
+
+void SchedulerCounters::clear() {
+    dispatches = selections = preemptions = context_switches = 0;
+    idle_periods = 0;
+    idle_time = 0;
+    queue_length_total = queue_length_max = scanned = 0;
+    fast_forwards = rounds_skipped = 0;
+    std::memset(phase_calls, 0, sizeof(phase_calls));
+    std::memset(phase_cycles, 0, sizeof(phase_cycles));
+}
+
+void SchedulerCounters::merge(const SchedulerCounters& other) {
+    dispatches += other.dispatches;
+    selections += other.selections;
+    preemptions += other.preemptions;
+    context_switches += other.context_switches;
+    idle_periods += other.idle_periods;
+    idle_time += other.idle_time;
+    queue_length_total += other.queue_length_total;
+    if (other.queue_length_max > queue_length_max) queue_length_max = other.queue_length_max;
+    scanned += other.scanned;
+    fast_forwards += other.fast_forwards;
+    rounds_skipped += other.rounds_skipped;
+    for (int p = 0; p < PHASE_COUNT; p++) {
+        phase_calls[p] += other.phase_calls[p];
+        phase_cycles[p] += other.phase_cycles[p];
+    }
+}
+
+void writeCountersJson(const SchedulerCounters& c, const std::string& label, std::ostream& out) {
+    static const char* PHASE_NAMES[PHASE_COUNT] = { "admission", "selection", "accounting" };
+    double per_selection = c.selections ? 1.0 / c.selections : 0;
+
+    out << "{\"scheduler\": \"" << label << "\""
+        << ", \"dispatches\": " << c.dispatches
+        << ", \"selections\": " << c.selections
+        << ", \"preemptions\": " << c.preemptions
+        << ", \"context_switches\": " << c.context_switches
+        << ", \"idle_periods\": " << c.idle_periods
+        << ", \"idle_time\": " << c.idle_time
+        << ", \"queue_length_mean\": " << c.queue_length_total * per_selection
+        << ", \"queue_length_max\": " << c.queue_length_max
+        << ", \"scanned_per_selection\": " << c.scanned * per_selection
+        << ", \"fast_forwards\": " << c.fast_forwards
+        << ", \"rounds_skipped\": " << c.rounds_skipped
+        << ", \"timer\": \"" << cycleUnit() << "\", \"phases\": {";
+    for (int p = 0; p < PHASE_COUNT; p++) {
+        out << (p ? ", " : "") << "\"" << PHASE_NAMES[p] << "\": {\"calls\": " << c.phase_calls[p]
+            << ", \"total\": " << c.phase_cycles[p]
+            << ", \"mean\": " << (c.phase_calls[p] ? double(c.phase_cycles[p]) / c.phase_calls[p] : 0)
+            << "}";
+    }
+    out << "}}\n";
+}
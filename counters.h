@@ -0,0 +1,108 @@
+#ifndef COUNTERS_H
+#define COUNTERS_H
+
+#include <cstdint>
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include "task_store.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+// Scheduler instrumentation is compiled in with -DSCHED_STATS=1 (make
+// STATS=1). Otherwise every counter update and phase timer is behind a
+// constant-false branch and the compiler drops it.
+#ifndef SCHED_STATS
+#define SCHED_STATS 0
+#endif
+
+inline bool statsEnabled() { return SCHED_STATS != 0; }
+
+// Timestamp for phase timings: the TSC on x86, steady_clock nanoseconds
+// elsewhere
+inline uint64_t cycleCount() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+// Unit of cycleCount(), for reports
+inline const char* cycleUnit() {
+#if defined(__x86_64__) || defined(__i386__)
+    return "tsc";
+#else
+    return "ns";
+#endif
+}
+
+enum SchedulerPhase {
+    PHASE_ADMISSION,     // an arrival entering the ready queue, with preemption check
+    PHASE_SELECTION,     // picking the next job and its slice
+    PHASE_ACCOUNTING,    // charging a finished slice, then requeueing or retiring
+    PHASE_COUNT
+};
+
+// What the dispatcher did during one run. Dispatches counts every slice
+// started, including slices a Round Robin fast-forward skipped over;
+// selections counts the ready-queue pops actually performed, and the
+// queue-length and scan figures are sampled at those.
+struct SchedulerCounters {
+    uint64_t dispatches;
+    uint64_t selections;
+    uint64_t preemptions;
+    uint64_t context_switches;   // dispatches of a different job than the last one
+    uint64_t idle_periods;
+    SimTime idle_time;           // CPU time units with nothing to run
+    uint64_t queue_length_total;
+    uint64_t queue_length_max;
+    uint64_t scanned;            // entries examined by the selections
+    uint64_t fast_forwards;      // RR rounds applied in closed form, in batches
+    uint64_t rounds_skipped;
+    uint64_t phase_calls[PHASE_COUNT];
+    uint64_t phase_cycles[PHASE_COUNT];
+
+    SchedulerCounters() { clear(); }
+    void clear();
+    void merge(const SchedulerCounters& other);
+
+    void sampleQueue(size_t length, size_t entries_scanned) {
+        selections++;
+        queue_length_total += length;
+        if (length > queue_length_max) queue_length_max = length;
+        scanned += entries_scanned;
+    }
+};
+
+// Adds the lifetime of a scope to one phase; does nothing unless built with
+// SCHED_STATS
+class PhaseTimer {
+private:
+    SchedulerCounters& counters;
+    SchedulerPhase phase;
+    uint64_t start;
+
+public:
+    PhaseTimer(SchedulerCounters& c, SchedulerPhase p)
+        : counters(c), phase(p), start(SCHED_STATS ? cycleCount() : 0) {}
+    ~PhaseTimer() {
+        if (SCHED_STATS) {
+            counters.phase_calls[phase]++;
+            counters.phase_cycles[phase] += cycleCount() - start;
+        }
+    }
+};
+
+// Writes the counters as one JSON object: the totals, mean ready-queue
+// length and entries scanned per selection, and calls, total and mean
+// timestamp ticks for each phase
+void writeCountersJson(const SchedulerCounters& counters, const std::string& label,
+                       std::ostream& out);
+
+#endif
@@ -0,0 +1,217 @@
+#include "executor.h"
+#include "results.h"
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+Executor::Executor(const ExecutorOptions& opts)
+    : options(opts), origin(std::chrono::steady_clock::now()), submissions(opts.capacity),
+      submitted(0), sleeping(0), finished(0), stopping(false), pinned_count(0) {
+    const std::string& name = options.algorithm;
+    if (name != "FCFS" && name != "SJF" && name != "Priority" && name != "RR") {
+        throw std::invalid_argument("executor cannot run algorithm: " + name);
+    }
+    if (options.quantum < 1 || options.unit < 1) {
+        throw std::invalid_argument("executor quantum and unit must be positive");
+    }
+    queue = makeReadyQueue(name, options.quantum);
+    queue->reset(jobs);
+
+    unsigned count = options.workers;
+    if (count == 0) count = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned i = 0; i < count; i++) {
+        pool.push_back(std::thread(&Executor::workerLoop, this, i));
+    }
+    // Workers read the clock only for submissions, which come after this
+    origin = std::chrono::steady_clock::now();
+}
+
+Executor::~Executor() {
+    try {
+        wait();
+    } catch (...) {
+        // Nobody is left to report it to
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    idle.notify_all();
+    for (size_t i = 0; i < pool.size(); i++) pool[i].join();
+}
+
+SimTime Executor::clock() const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - origin).count();
+}
+
+void Executor::submit(int id, Work work, SimTime estimate, int priority) {
+    Submission s;
+    s.id = id;
+    s.estimate = estimate;
+    s.priority = priority;
+    s.work = std::move(work);
+    submitted.fetch_add(1);
+    s.submitted = clock();
+    while (!submissions.tryPush(std::move(s))) std::this_thread::yield();
+
+    // Pairs with the fence in workerLoop(): either a worker about to sleep
+    // sees this submission, or this sees the worker and wakes it
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleeping.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(mutex);
+        idle.notify_one();
+    }
+}
+
+void Executor::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    finished_all.wait(lock, [this] { return finished == submitted.load(); });
+    if (error) {
+        std::exception_ptr e = error;
+        error = nullptr;
+        std::rethrow_exception(e);
+    }
+}
+
+// Moves every pending submission into the ready queue; called with the
+// mutex held
+void Executor::admit() {
+    Submission s;
+    while (submissions.tryPop(s)) {
+        int job = jobs.size();
+        jobs.add(s.id, s.submitted, s.estimate, s.priority);
+        jobs.remainingTime(job) = 1;    // until it finishes
+        works.push_back(std::move(s.work));
+        service.push_back(0);
+        queue->push(job);
+    }
+}
+
+void Executor::workerLoop(unsigned index) {
+    if (options.pin) pin(index);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        admit();
+        if (queue->empty()) {
+            if (stopping) return;
+            sleeping.fetch_add(1);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            admit();
+            if (queue->empty() && !stopping) idle.wait(lock);
+            sleeping.fetch_sub(1);
+            continue;
+        }
+
+        SimTime now = clock();
+        queue->tick(now);
+        int job = queue->pop();
+        Work work = std::move(works[job]);
+        if (jobs.startTime(job) < 0) jobs.startTime(job) = now;
+        // RR's quantum; the other policies run a task to completion
+        const SimTime forever = std::numeric_limits<SimTime>::max();
+        SimTime slice = queue->slice(job, forever);
+        slice = slice >= forever / options.unit ? forever : slice * options.unit;
+        lock.unlock();
+
+        bool done = false;
+        std::exception_ptr thrown;
+        SimTime begin = clock(), end = begin;
+        try {
+            do {
+                done = work();
+                end = clock();
+            } while (!done && end - begin < slice);
+        } catch (...) {
+            thrown = std::current_exception();
+            done = true;
+            end = clock();
+        }
+
+        lock.lock();
+        service[job] += end - begin;
+        if (!done) {
+            works[job] = std::move(work);
+            queue->push(job);
+            continue;
+        }
+        if (thrown && !error) error = thrown;
+        jobs.remainingTime(job) = 0;
+        jobs.completionTime(job) = end;
+        finished++;
+        if (finished == submitted.load()) finished_all.notify_all();
+    }
+}
+
+// Pins worker `index` to the index-th CPU in the process's affinity mask,
+// wrapping around
+void Executor::pin(unsigned index) {
+#ifdef __linux__
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) return;
+    int count = CPU_COUNT(&allowed);
+    if (count == 0) return;
+    int target = index % count;
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (!CPU_ISSET(cpu, &allowed) || target-- > 0) continue;
+        cpu_set_t one;
+        CPU_ZERO(&one);
+        CPU_SET(cpu, &one);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(one), &one) == 0) pinned_count++;
+        return;
+    }
+#else
+    (void)index;
+#endif
+}
+
+TaskStore Executor::results() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    SimTime unit = options.unit;
+    TaskStore done;
+    done.reserve(finished);
+    for (size_t i = 0; i < jobs.size(); i++) {
+        if (jobs.remainingTime(i) != 0) continue;
+        SimTime arrival = (jobs.arrivalTime(i) + unit / 2) / unit;
+        SimTime completion = (jobs.completionTime(i) + unit / 2) / unit;
+        // Rounded separately, the service time could exceed the turnaround
+        SimTime burst = std::min((service[i] + unit / 2) / unit, completion - arrival);
+        size_t k = done.size();
+        done.add(jobs.taskId(i), arrival, burst, jobs.priority(i));
+        done.remainingTime(k) = 0;
+        done.startTime(k) = std::max(arrival, (jobs.startTime(i) + unit / 2) / unit);
+        done.completionTime(k) = completion;
+    }
+    return done;
+}
+
+void Executor::printMetrics() const {
+    TaskStore done = results();
+    std::cout << "\n=== Executor Results (" << options.algorithm << ", "
+              << pool.size() << " workers) ===\n";
+    std::cout.flush();
+    {
+        OutputBuffer out(1);
+        TableSink table(out, TABLE_TASKS);
+        writeResults(done, table);
+    }
+    StreamingMetrics stream;
+    stream.record(done);
+    printPerformanceMetrics(stream, pool.size());
+}
+
+void Executor::printSummary() const {
+    TaskStore done = results();
+    std::cout << "\n=== Executor Results (" << options.algorithm << ", "
+              << pool.size() << " workers) ===\n";
+    StreamingMetrics stream;
+    stream.record(done);
+    printPerformanceMetrics(stream, pool.size());
+}
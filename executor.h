@@ -0,0 +1,215 @@
+#ifndef EXECUTOR_H
+#define EXECUTOR_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "simulation.h"
+
+// Bounded lock-free multi-producer multi-consumer queue (Vyukov's ring).
+// Every cell carries a sequence number saying whether it is free for the
+// push at a position or full for the pop at it, so a push or pop is one CAS
+// on the shared index and one release store to the cell. Capacity is
+// rounded up to a power of two.
+template <class T>
+class MpmcQueue {
+private:
+    static const size_t LINE = 64;
+
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    size_t mask;
+    // The indices sit on their own cache lines, away from each other
+    char pad0[LINE];
+    std::atomic<size_t> tail;    // next push
+    char pad1[LINE - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t> head;    // next pop
+    char pad2[LINE - sizeof(std::atomic<size_t>)];
+
+public:
+    explicit MpmcQueue(size_t capacity);
+
+    // False if the queue is full
+    bool tryPush(T&& value);
+    // False if the queue is empty
+    bool tryPop(T& value);
+    size_t capacity() const { return mask + 1; }
+};
+
+template <class T>
+MpmcQueue<T>::MpmcQueue(size_t capacity) : mask(0), tail(0), head(0) {
+    size_t size = 2;
+    while (size < capacity) size <<= 1;
+    cells.reset(new Cell[size]);
+    for (size_t i = 0; i < size; i++) cells[i].sequence.store(i, std::memory_order_relaxed);
+    mask = size - 1;
+}
+
+template <class T>
+bool MpmcQueue<T>::tryPush(T&& value) {
+    size_t pos = tail.load(std::memory_order_relaxed);
+    for (;;) {
+        Cell& cell = cells[pos & mask];
+        size_t seq = cell.sequence.load(std::memory_order_acquire);
+        intptr_t diff = intptr_t(seq) - intptr_t(pos);
+        if (diff == 0) {
+            // A failed CAS reloads pos
+            if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                cell.value = std::move(value);
+                cell.sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = tail.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+template <class T>
+bool MpmcQueue<T>::tryPop(T& value) {
+    size_t pos = head.load(std::memory_order_relaxed);
+    for (;;) {
+        Cell& cell = cells[pos & mask];
+        size_t seq = cell.sequence.load(std::memory_order_acquire);
+        intptr_t diff = intptr_t(seq) - intptr_t(pos + 1);
+        if (diff == 0) {
+            if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                value = std::move(cell.value);
+                cell.sequence.store(pos + mask + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = head.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+// A callable run by the Executor. It is called until it returns true, and
+// every earlier return is a yield point where RR may switch to another
+// task. Work that runs to completion in one call just returns true.
+typedef std::function<bool()> Work;
+
+struct ExecutorOptions {
+    std::string algorithm;   // "FCFS", "SJF", "Priority" or "RR"
+    SimTime quantum;         // RR slice, in time units
+    SimTime unit;            // nanoseconds per reported time unit
+    unsigned workers;        // 0 for one per hardware thread
+    size_t capacity;         // submission queue slots
+    bool pin;                // pin worker i to the i-th CPU the process may use
+
+    ExecutorOptions()
+        : algorithm("FCFS"), quantum(1000), unit(1000), workers(0), capacity(65536),
+          pin(true) {}
+};
+
+// Runs submitted work on a pool of worker threads, in the order a ready-queue
+// policy picks. Submissions go through a lock-free MpmcQueue; an idle worker
+// moves them into one shared ready queue (the simulator's FCFS, SJF,
+// Priority or RR policy, under a mutex) and takes the next task from it. SJF
+// orders on the estimated cost given at submission and Priority on the
+// priority, lower first. A task runs until it finishes or, under RR, reaches
+// a yield point with its quantum used up, and then goes to the back of the
+// queue. Nothing is preempted between yield points.
+//
+// Every task's submission, first dispatch, completion and measured service
+// time (the wall-clock time spent running it) are kept for the report, so
+// the same workload can be compared with a TaskScheduler run on as many
+// CPUs. Times are measured from when the workers have started and reported
+// in `unit` nanoseconds.
+class Executor {
+private:
+    struct Submission {
+        int id;
+        SimTime estimate;
+        int priority;
+        SimTime submitted;    // nanoseconds since origin
+        Work work;
+
+        Submission() : id(0), estimate(0), priority(0), submitted(0) {}
+    };
+
+    ExecutorOptions options;
+    std::chrono::steady_clock::time_point origin;
+    MpmcQueue<Submission> submissions;
+    std::atomic<size_t> submitted;
+    std::atomic<int> sleeping;        // workers waiting for submissions
+
+    // Guarded by mutex: the ready queue and per-task records, indexed by
+    // admission. The store holds submission times and estimates as inputs
+    // and first dispatch and completion as outputs, in nanoseconds, with
+    // remaining time 0 once a task has finished.
+    mutable std::mutex mutex;
+    std::condition_variable idle;
+    std::condition_variable finished_all;
+    std::unique_ptr<ReadyQueue> queue;
+    TaskStore jobs;
+    std::vector<Work> works;
+    std::vector<SimTime> service;
+    size_t finished;
+    bool stopping;
+    std::exception_ptr error;
+
+    std::vector<std::thread> pool;
+    std::atomic<unsigned> pinned_count;
+
+    SimTime clock() const;
+    void admit();
+    void workerLoop(unsigned index);
+    void pin(unsigned index);
+
+public:
+    // Starts the workers. Throws std::invalid_argument for a policy other
+    // than FCFS, SJF, Priority or RR, or a quantum or unit below 1.
+    explicit Executor(const ExecutorOptions& options);
+    // Waits for every submitted task, then stops the workers. Submitting
+    // concurrently with destruction is not allowed.
+    ~Executor();
+
+    Executor(const Executor&) = delete;
+    Executor& operator=(const Executor&) = delete;
+
+    // Queues `work` from any thread. `estimate` is the cost SJF orders on,
+    // in any unit. Spins while the submission queue is full.
+    void submit(int id, Work work, SimTime estimate = 0, int priority = 0);
+    // Blocks until every task submitted so far has finished. Rethrows the
+    // first exception a task threw since the last wait(); a task that
+    // throws counts as finished.
+    void wait();
+
+    // The tasks finished so far in admission order, in time units: arrival
+    // is the submission, burst the measured service time, and start and
+    // completion the first dispatch and the end of the last slice, so
+    // waiting time is the queueing delay including any waits between RR
+    // slices
+    TaskStore results() const;
+
+    // Same format as TaskScheduler::printMetrics(), utilisation measured
+    // against all workers
+    void printMetrics() const;
+    void printSummary() const;
+
+    const std::string& algorithm() const { return options.algorithm; }
+    unsigned workers() const { return pool.size(); }
+    // Workers whose CPU affinity was set
+    unsigned pinned() const { return pinned_count.load(); }
+    std::chrono::steady_clock::time_point started() const { return origin; }
+};
+
+#endif
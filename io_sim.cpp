@@ -0,0 +1,269 @@
+#include "io_sim.h"
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+// I/O table
+void IoTable::add(size_t index, const std::vector<IoPhase>& task_phases) {
+    if (index + 1 < first.size()) {
+        throw std::invalid_argument("I/O phases must be added in task order");
+    }
+    for (size_t k = 0; k < task_phases.size(); k++) {
+        const IoPhase& p = task_phases[k];
+        if (p.device < 0 || p.io_time < 0 || p.cpu_time < 0) {
+            throw std::invalid_argument("I/O phase with a negative device or time");
+        }
+    }
+
+    while (first.size() <= index) first.push_back(phases.size());
+    for (size_t k = 0; k < task_phases.size(); k++) {
+        phases.push_back(task_phases[k]);
+        device_count = std::max(device_count, task_phases[k].device + 1);
+    }
+    first.push_back(phases.size());
+}
+
+void IoTable::permute(const std::vector<int>& order) {
+    if (empty()) return;
+    std::vector<size_t> sorted_first(1, 0);
+    std::vector<IoPhase> sorted;
+    sorted.reserve(phases.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        for (size_t k = 0; k < phaseCount(order[i]); k++) sorted.push_back(phase(order[i], k));
+        sorted_first.push_back(sorted.size());
+    }
+    first.swap(sorted_first);
+    phases.swap(sorted);
+}
+
+void IoTable::clear() {
+    first.assign(1, 0);
+    phases.clear();
+    device_count = 0;
+}
+
+SimTime cpuTime(SimTime first_burst, const std::vector<IoPhase>& phases) {
+    SimTime total = first_burst;
+    for (size_t k = 0; k < phases.size(); k++) total += phases[k].cpu_time;
+    return total;
+}
+
+void sortByArrival(TaskStore& tasks, IoTable& io) {
+    if (!io.empty()) io.permute(arrivalOrder(tasks));
+    tasks.sortByArrival();
+}
+
+// Simulator
+IoSimulator::IoSimulator(TaskStore& store, const IoTable& table)
+    : tasks(store), io(table), current_time(0), running(-1), run_since(0),
+      dispatch_tag(0), io_tag(0), busy_devices(0), dispatch_count(0), last_job(-1),
+      timeline(nullptr), results(nullptr) {}
+
+void IoSimulator::run(const ReadyQueue& policy) {
+    size_t n = tasks.size();
+    tasks.resetOutputs();
+
+    // The ready queue sees one CPU burst at a time: the first one here,
+    // then each phase's as its I/O completes
+    work = tasks.view();
+    for (size_t i = 0; i < n; i++) {
+        size_t count = io.phaseCount(i);
+        if (count == 0) continue;
+        SimTime first = tasks.burstTime(i);
+        for (size_t k = 0; k < count; k++) first -= io.phase(i, k).cpu_time;
+        if (first < 0) {
+            throw std::invalid_argument("task " + std::to_string(tasks.taskId(i)) +
+                                        " has less CPU time than its I/O phases");
+        }
+        work.setInputs(i, tasks.arrivalTime(i), first, tasks.priority(i));
+    }
+    work.resetOutputs();
+
+    queue = policy.clone();
+    queue->reset(work);
+    devices.clear();
+    devices.resize(io.devices());
+    next_phase.assign(n, 0);
+    ready_at.assign(n, -1);
+    io_queued.assign(n, 0);
+    events.reset(work);
+    current_time = 0;
+    running = -1;
+    run_since = 0;
+    dispatch_tag = 0;
+    io_tag = 0;
+    busy_devices = 0;
+    dispatch_count = 0;
+    last_job = -1;
+    counts.clear();
+    stats = IoStats();
+    stats.devices.resize(devices.size());
+    stats.io_time.assign(n, 0);
+    // Waiting time in the results is time off the CPU and out of devices
+    if (results) results->excludeFromWaiting(stats.io_time.data());
+
+    size_t completed = 0;
+    while (completed < n) {
+        if (running < 0 && !queue->empty()) dispatch();
+
+        // Deliver every event at the next instant before dispatching again
+        SimTime next = events.nextTime();
+        SimTime gap = next - current_time;
+        if (running >= 0) stats.cpu_busy += gap;
+        if (busy_devices > 0) stats.io_busy += gap;
+        if (running >= 0 && busy_devices > 0) stats.overlap += gap;
+        if (SCHED_STATS && running < 0 && gap > 0) {
+            counts.idle_periods++;
+            counts.idle_time += gap;
+        }
+        current_time = next;
+        while (!events.empty() && events.nextTime() == current_time) {
+            Event e = events.pop();
+
+            if (e.type == EVENT_ARRIVAL) {
+                PhaseTimer timer(counts, PHASE_ADMISSION);
+                admit(e.job);
+            } else if (e.type == EVENT_IO_DONE) {
+                PhaseTimer timer(counts, PHASE_ADMISSION);
+                finishIo(e.cpu);
+                const IoPhase& p = io.phase(e.job, next_phase[e.job]++);
+                work.setInputs(e.job, current_time, p.cpu_time, tasks.priority(e.job));
+                work.remainingTime(e.job) = p.cpu_time;
+                admit(e.job);
+            } else if (e.job == running && e.tag == dispatch_tag) {
+                PhaseTimer timer(counts, PHASE_ACCOUNTING);
+                account();
+                int job = running;
+                running = -1;
+                if (work.remainingTime(job) > 0) {
+                    queue->push(job);
+                } else if (next_phase[job] < io.phaseCount(job)) {
+                    queue->block(job);
+                    request(job);
+                } else {
+                    tasks.remainingTime(job) = 0;
+                    tasks.completionTime(job) = current_time;
+                    completed++;
+                    if (results) results->write(tasks, job);
+                }
+            }
+        }
+    }
+
+    if (results) results->excludeFromWaiting(nullptr);
+
+    // Every moment of a task's life is on the CPU, in the ready queue,
+    // queued at a device or doing I/O
+    double ready = 0;
+    for (size_t i = 0; i < n; i++) {
+        ready += tasks.completionTime(i) - tasks.arrivalTime(i) - tasks.burstTime(i);
+        ready -= stats.io_time[i];
+        stats.cpu_bursts += io.phaseCount(i) + 1;
+    }
+    for (size_t d = 0; d < devices.size(); d++) ready -= stats.devices[d].queue_time;
+    stats.ready_wait = static_cast<SimTime>(ready);
+}
+
+// A new task or one back from I/O
+void IoSimulator::admit(int job) {
+    ready_at[job] = current_time;
+    queue->push(job);
+    if (running >= 0) {
+        account();
+        if (work.remainingTime(running) > 0 && queue->preempts(job, running)) {
+            if (SCHED_STATS) counts.preemptions++;
+            queue->push(running);
+            running = -1;
+        }
+    }
+}
+
+void IoSimulator::dispatch() {
+    PhaseTimer timer(counts, PHASE_SELECTION);
+    size_t length = queue->size();
+    queue->tick(current_time);
+    running = queue->pop();
+    if (SCHED_STATS) {
+        counts.sampleQueue(length, queue->scanned());
+        counts.dispatches++;
+        if (running != last_job) counts.context_switches++;
+        last_job = running;
+    }
+    if (tasks.startTime(running) < 0) {
+        tasks.startTime(running) = current_time;
+    }
+    if (ready_at[running] >= 0) {
+        stats.response.record(current_time - ready_at[running]);
+        ready_at[running] = -1;
+    }
+    run_since = current_time;
+    dispatch_tag++;
+    dispatch_count++;
+
+    SimTime slice = queue->slice(running, work.remainingTime(running));
+    events.schedule(Event(current_time + slice, EVENT_SLICE_END, running, dispatch_tag));
+}
+
+void IoSimulator::account() {
+    if (SCHED_TIMELINE && timeline) {
+        timeline->record(tasks.taskId(running), 0, run_since, current_time);
+    }
+    work.remainingTime(running) -= current_time - run_since;
+    run_since = current_time;
+}
+
+// Queues the job's next I/O at its device
+void IoSimulator::request(int job) {
+    int d = io.phase(job, next_phase[job]).device;
+    Device& device = devices[d];
+    io_queued[job] = current_time;
+    if (device.serving < 0) {
+        serve(d, job);
+        return;
+    }
+    device.waiting.push(job);
+    stats.devices[d].max_queue = std::max(stats.devices[d].max_queue, device.waiting.size());
+}
+
+void IoSimulator::serve(int d, int job) {
+    Device& device = devices[d];
+    device.serving = job;
+    device.since = current_time;
+    busy_devices++;
+    stats.devices[d].queue_time += current_time - io_queued[job];
+    SimTime length = io.phase(job, next_phase[job]).io_time;
+    events.schedule(Event(current_time + length, EVENT_IO_DONE, job, ++io_tag, d));
+}
+
+void IoSimulator::finishIo(int d) {
+    Device& device = devices[d];
+    stats.devices[d].busy_time += current_time - device.since;
+    stats.devices[d].served++;
+    stats.io_time[device.serving] += current_time - device.since;
+    device.serving = -1;
+    busy_devices--;
+    if (!device.waiting.empty()) serve(d, device.waiting.pop());
+}
+
+const SimTime* ioTimes(const IoTable& io, const IoStats& stats, size_t tasks) {
+    return !io.empty() && stats.io_time.size() == tasks ? stats.io_time.data() : nullptr;
+}
+
+void printIoStats(const IoStats& stats, SimTime span) {
+    double scale = span > 0 ? 100.0 / span : 0;
+    std::cout << "\n--- I/O Metrics ---\n";
+    std::cout << "CPU Busy: " << stats.cpu_busy << " (" << stats.cpu_busy * scale << "%)\n";
+    std::cout << "I/O Busy: " << stats.io_busy << " (" << stats.io_busy * scale << "%)\n";
+    std::cout << "CPU/I/O Overlap: " << stats.overlap << " (" << stats.overlap * scale << "%)\n";
+    std::cout << "Device\tBusy\tUtilization\tServed\tAvg Queue Wait\tMax Queue\n";
+    for (size_t d = 0; d < stats.devices.size(); d++) {
+        const DeviceStats& s = stats.devices[d];
+        double wait = s.served ? double(s.queue_time) / s.served : 0;
+        std::cout << "IO" << d << "\t" << s.busy_time << "\t"
+                  << s.busy_time * scale << "%\t\t"
+                  << s.served << "\t" << wait << "\t\t" << s.max_queue << "\n";
+    }
+    double per_burst = stats.cpu_bursts ? double(stats.ready_wait) / stats.cpu_bursts : 0;
+    std::cout << "Average Ready Wait per CPU Burst: " << per_burst << "\n";
+    printPercentiles("CPU Burst Response", stats.response);
+}
@@ -0,0 +1,152 @@
+#ifndef IO_SIM_H
+#define IO_SIM_H
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include "simulation.h"
+
+// One trip to an I/O device and the CPU burst that follows it. A task's
+// burst_time is its first CPU burst; its phases follow in order.
+struct IoPhase {
+    int device;
+    SimTime io_time;
+    SimTime cpu_time;
+
+    IoPhase(int d, SimTime io, SimTime cpu) : device(d), io_time(io), cpu_time(cpu) {}
+};
+
+// The I/O phases of the tasks in a TaskStore, as compressed rows by store
+// index. Tasks past the last row added have none. The store's burst column
+// holds each task's total CPU time.
+class IoTable {
+private:
+    std::vector<size_t> first;     // row i is phases[first[i] .. first[i + 1])
+    std::vector<IoPhase> phases;
+    int device_count;
+
+public:
+    IoTable() : first(1, 0), device_count(0) {}
+
+    // Sets the phases of task `index`, which must be past the last row
+    // added. Throws std::invalid_argument for a negative device or time.
+    void add(size_t index, const std::vector<IoPhase>& task_phases);
+    // Reorders the rows like a TaskStore reordered by `order` (new row i is
+    // old row order[i])
+    void permute(const std::vector<int>& order);
+    void clear();
+
+    bool empty() const { return phases.empty(); }
+    // One more than the highest device used
+    int devices() const { return device_count; }
+    size_t phaseCount(size_t task) const {
+        return task + 1 < first.size() ? first[task + 1] - first[task] : 0;
+    }
+    const IoPhase& phase(size_t task, size_t k) const { return phases[first[task] + k]; }
+};
+
+// Total CPU time of a task: `first_burst` plus every phase's CPU burst
+SimTime cpuTime(SimTime first_burst, const std::vector<IoPhase>& phases);
+
+// TaskStore::sortByArrival(), taking each task's I/O row along
+void sortByArrival(TaskStore& tasks, IoTable& io);
+
+struct DeviceStats {
+    SimTime busy_time;
+    size_t served;
+    SimTime queue_time;       // waited behind other requests, in total
+    size_t max_queue;
+
+    DeviceStats() : busy_time(0), served(0), queue_time(0), max_queue(0) {}
+};
+
+// Where the time of an I/O run went
+struct IoStats {
+    SimTime cpu_busy;
+    SimTime io_busy;          // at least one device busy
+    SimTime overlap;          // the CPU and at least one device busy
+    SimTime ready_wait;       // in the ready queue, over every CPU burst
+    size_t cpu_bursts;
+    LatencyHistogram response;   // ready to first dispatch, per CPU burst
+    std::vector<DeviceStats> devices;
+    std::vector<SimTime> io_time;   // per task by store index, served by devices
+
+    IoStats() : cpu_busy(0), io_busy(0), overlap(0), ready_wait(0), cpu_bursts(0) {}
+};
+
+// Single-CPU discrete-event simulation of tasks that alternate CPU and I/O
+// bursts. Every device serves its requests one at a time in FCFS order,
+// concurrently with the CPU and the other devices. A task waiting for or
+// doing I/O is out of the ready queue; when its I/O completes it is
+// admitted again like an arrival, and may preempt under a preemptive
+// policy. The queue orders on the current CPU burst: SJF on its length,
+// SRTF on what is left of it, and FIFO policies and tie-breaks on when it
+// became ready.
+class IoSimulator {
+private:
+    struct Device {
+        JobRing waiting;
+        int serving;
+        SimTime since;
+
+        Device() : serving(-1), since(0) {}
+    };
+
+    TaskStore& tasks;
+    const IoTable& io;
+    TaskStore work;            // per-burst inputs the ready queue orders on
+    std::unique_ptr<ReadyQueue> queue;
+    std::vector<Device> devices;
+    std::vector<unsigned> next_phase;
+    std::vector<SimTime> ready_at;   // of the current CPU burst, -1 once run
+    std::vector<SimTime> io_queued;
+    EventQueue events;
+    SimTime current_time;
+    int running;
+    SimTime run_since;
+    unsigned dispatch_tag;
+    unsigned io_tag;
+    int busy_devices;
+    size_t dispatch_count;
+    int last_job;
+    Timeline* timeline;
+    ResultSink* results;
+    SchedulerCounters counts;   // updated only in SCHED_STATS builds
+    IoStats stats;
+
+    void admit(int job);
+    void dispatch();
+    void account();
+    void request(int job);
+    void serve(int device, int job);
+    void finishIo(int device);
+
+public:
+    // Results are written back into the store's output columns; `io` must
+    // have no more rows than the store and outlive the simulator
+    IoSimulator(TaskStore& store, const IoTable& io);
+
+    void run(const ReadyQueue& policy);
+
+    // Appends every slice of CPU time to `t` on CPU 0; a no-op unless built
+    // with SCHED_TIMELINE
+    void recordTimeline(Timeline* t) { timeline = t; }
+
+    // Writes every task to `s` as it completes; null stops it
+    void streamTo(ResultSink* s) { results = s; }
+
+    SimTime now() const { return current_time; }
+    size_t dispatches() const { return dispatch_count; }
+    const SchedulerCounters& counters() const { return counts; }
+    const IoStats& ioStats() const { return stats; }
+};
+
+// The per-task I/O times of the last run with `io` over `tasks` tasks, for
+// excluding from waiting time, or null if the run had no I/O
+const SimTime* ioTimes(const IoTable& io, const IoStats& stats, size_t tasks);
+
+// Prints CPU and device utilisation over `span` time units, how much of
+// it overlapped, device queueing and the per-burst response times
+void printIoStats(const IoStats& stats, SimTime span);
+
+#endif
@@ -1,5 +1,13 @@
 #include "scheduler.h"
+#include "compare.h"
+#include "tuner.h"
+#include "replicate.h"
+#include "executor.h"
 #include <iostream>
+#include <cstdlib>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
 
 void testExercise1() {
     std::cout << "\n Exercise 1: FCFS \n";
@@ -121,7 +129,275 @@ void testPart3_Priority() {
     scheduler.printMetrics();
 }
 
-int main() {
+// Options of a trace replay, given before the trace path
+struct TraceOptions {
+    const char* timeline_path;     // --timeline <out.json>
+    const char* results_format;    // --results <format> <path>
+    const char* results_path;
+    SimTime snapshot_time;         // --snapshot <time> <file>
+    const char* snapshot_path;
+    const char* resume_path;       // --resume <file>
+    
+    TraceOptions()
+        : timeline_path(nullptr), results_format(nullptr), results_path(nullptr),
+          snapshot_time(-1), snapshot_path(nullptr), resume_path(nullptr) {}
+};
+
+// Replays a workload trace: ./scheduler <trace.csv> [algorithm] [quantum] [cpus]
+// With a timeline path the schedule is also written as a Chrome trace. With
+// a results sink every task is written to it as it completes, and only the
+// summary is printed. A snapshot file receives the state at the given time,
+// and a run resumed from one prints what the whole run would have.
+int runTrace(int argc, char* argv[], const TraceOptions& options) {
+    const char* timeline_path = options.timeline_path;
+    std::string algorithm = argc > 2 ? argv[2] : "FCFS";
+    SimTime quantum = argc > 3 ? std::atoll(argv[3]) : 4;
+    if (timeline_path && !timelineEnabled()) {
+        std::cerr << "error: timeline recording is compiled out; rebuild with make TIMELINE=1\n";
+        return 1;
+    }
+    
+    Timeline timeline;
+    std::unique_ptr<TaskScheduler> owned;
+    std::unique_ptr<OutputBuffer> results_out;
+    std::unique_ptr<ResultSink> results;
+    try {
+        owned.reset(new TaskScheduler(algorithm, quantum));
+        TaskScheduler& scheduler = *owned;
+        if (argc > 4) {
+            scheduler.setCpus(std::atoi(argv[4]));
+        }
+        if (timeline_path) {
+            scheduler.recordTimeline(&timeline);
+        }
+        
+        if (options.results_format) {
+            results_out.reset(new OutputBuffer(std::string(options.results_path)));
+            results = makeResultSink(options.results_format, *results_out);
+            if (!results) {
+                std::cerr << "error: unknown results format: " << options.results_format << "\n";
+                return 1;
+            }
+            scheduler.streamResults(results.get());
+        }
+        
+        TraceLoadStats stats = scheduler.loadTrace(argv[1]);
+        std::cerr << "Loaded " << stats.tasks << " tasks (" << stats.bytes << " bytes) in "
+                  << stats.seconds << " s: " << stats.tasksPerSecond() << " tasks/s, "
+                  << stats.megabytesPerSecond() << " MB/s\n";
+        
+        if (options.snapshot_path) {
+            scheduler.snapshotAt(options.snapshot_time, options.snapshot_path);
+        }
+        if (options.resume_path) {
+            scheduler.resume(options.resume_path);
+        } else {
+            scheduler.run();
+        }
+        if (results) results->finish();
+    } catch (const std::runtime_error& e) {
+        std::cerr << "error: " << e.what() << "\n";
+        return 1;
+    } catch (const std::invalid_argument& e) {
+        std::cerr << "error: " << e.what() << "\n";
+        return 1;
+    }
+    
+    if (!results) {
+        owned->printMetrics();
+    } else if (std::string(options.results_path) != "-") {
+        owned->printSummary();
+    }
+    
+    if (timeline_path) {
+        try {
+            writeChromeTrace(timeline, timeline_path);
+            std::cerr << "Wrote " << timeline.size() << " slices to " << timeline_path << "\n";
+        } catch (const std::runtime_error& e) {
+            std::cerr << "error: " << e.what() << "\n";
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Compares every policy on one trace:
+// ./scheduler --compare <trace.csv> [rr_quantum ...]
+int runComparison(int argc, char* argv[]) {
+    std::vector<SimTime> quanta;
+    for (int i = 3; i < argc; i++) quanta.push_back(std::atoll(argv[i]));
+    if (quanta.empty()) quanta.push_back(4);
+    
+    TaskStore workload;
+    try {
+        TraceLoadStats stats = loadTrace(argv[2], workload);
+        std::cerr << "Loaded " << stats.tasks << " tasks in " << stats.seconds << " s\n";
+    } catch (const std::runtime_error& e) {
+        std::cerr << "error: " << e.what() << "\n";
+        return 1;
+    }
+    
+    try {
+        printComparison(compareSchedulers(workload, allPolicies(quanta)));
+    } catch (const std::invalid_argument& e) {
+        std::cerr << "error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+// Searches for the best RR quantum on one trace:
+// ./scheduler --tune <trace.csv> [min_quantum max_quantum] [p99_target]
+// With a p99 target the search minimises p99 turnaround among quanta that
+// meet it; otherwise it minimises average waiting time.
+int runTuning(int argc, char* argv[]) {
+    TuneOptions options;
+    if (argc > 4) {
+        options.min_quantum = std::atoll(argv[3]);
+        options.max_quantum = std::atoll(argv[4]);
+    }
+    if (argc > 5) {
+        options.p99_target = std::atof(argv[5]);
+        options.objective = TUNE_P99_TURNAROUND;
+    }
+    
+    TaskStore workload;
+    try {
+        TraceLoadStats stats = loadTrace(argv[2], workload);
+        std::cerr << "Loaded " << stats.tasks << " tasks in " << stats.seconds << " s\n";
+    } catch (const std::runtime_error& e) {
+        std::cerr << "error: " << e.what() << "\n";
+        return 1;
+    }
+    
+    try {
+        printTuning(tuneQuantum(workload, options), options);
+    } catch (const std::invalid_argument& e) {
+        std::cerr << "error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+// Replicates one policy over independent synthetic workloads:
+// ./scheduler --replicate <algorithm> [quantum] [replicas] [tasks] [load] [burst] [seed]
+// and reports each metric's mean with a 95% confidence interval.
+int runReplication(int argc, char* argv[]) {
+    ReplicationOptions options;
+    options.algorithm = argv[2];
+    if (argc > 3) options.quantum = std::atoll(argv[3]);
+    if (argc > 4) options.replicas = std::strtoull(argv[4], nullptr, 10);
+    if (argc > 5) options.workload.tasks = std::strtoull(argv[5], nullptr, 10);
+    if (argc > 6) options.workload.load = std::atof(argv[6]);
+    if (argc > 7 && !parseBurstDistribution(argv[7], options.workload.burst)) {
+        std::cerr << "error: unknown burst distribution: " << argv[7] << "\n";
+        return 1;
+    }
+    if (argc > 8) options.workload.seed = std::strtoull(argv[8], nullptr, 10);
+    
+    try {
+        printReplication(replicate(options), options);
+    } catch (const std::invalid_argument& e) {
+        std::cerr << "error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+// Runs a trace as real work on a worker pool and compares it with the
+// simulation: ./scheduler --execute <trace.csv> [algorithm] [quantum] [workers] [unit_us]
+// Each task is submitted at its arrival and spins for its burst, one time
+// unit (default 100 us) per yield point; both reports are in time units.
+int runExecution(int argc, char* argv[]) {
+    ExecutorOptions options;
+    options.algorithm = argc > 3 ? argv[3] : "FCFS";
+    options.quantum = argc > 4 ? std::atoll(argv[4]) : 4;
+    options.workers = argc > 5 ? std::atoi(argv[5]) : 1;
+    options.unit = (argc > 6 ? std::atoll(argv[6]) : 100) * 1000;
+    
+    TaskStore tasks;
+    try {
+        TraceLoadStats stats = loadTrace(argv[2], tasks);
+        std::cerr << "Loaded " << stats.tasks << " tasks in " << stats.seconds << " s\n";
+        TaskScheduler scheduler(options.algorithm, options.quantum);
+        scheduler.setCpus(options.workers);
+        scheduler.useWorkload(tasks);
+        Executor executor(options);
+        
+        std::vector<int> order = arrivalOrder(tasks);
+        std::chrono::nanoseconds unit(options.unit);
+        for (size_t k = 0; k < order.size(); k++) {
+            int i = order[k];
+            std::this_thread::sleep_until(executor.started() + tasks.arrivalTime(i) * unit);
+            SimTime left = tasks.burstTime(i);
+            Work spin = [left, unit]() mutable {
+                if (left == 0) return true;
+                std::chrono::steady_clock::time_point until = std::chrono::steady_clock::now() + unit;
+                while (std::chrono::steady_clock::now() < until) {}
+                return --left == 0;
+            };
+            executor.submit(tasks.taskId(i), spin, tasks.burstTime(i), tasks.priority(i));
+        }
+        executor.wait();
+        
+        // Simulated afterwards, so it does not delay the first arrivals
+        scheduler.run();
+        scheduler.printSummary();
+        executor.printSummary();
+        std::cout << "Pinned Workers: " << executor.pinned() << "/" << executor.workers() << "\n";
+    } catch (const std::runtime_error& e) {
+        std::cerr << "error: " << e.what() << "\n";
+        return 1;
+    } catch (const std::invalid_argument& e) {
+        std::cerr << "error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 2 && std::string(argv[1]) == "--compare") {
+        return runComparison(argc, argv);
+    }
+    if (argc > 2 && std::string(argv[1]) == "--tune") {
+        return runTuning(argc, argv);
+    }
+    if (argc > 2 && std::string(argv[1]) == "--replicate") {
+        return runReplication(argc, argv);
+    }
+    if (argc > 2 && std::string(argv[1]) == "--execute") {
+        return runExecution(argc, argv);
+    }
+    
+    // ./scheduler [--timeline <out.json>] [--results <format> <path>]
+    //             [--snapshot <time> <file>] [--resume <file>]
+    //             <trace.csv> [algorithm] [quantum] [cpus]
+    TraceOptions options;
+    int skip = 0;
+    for (;;) {
+        std::string option = argc > skip + 1 ? argv[skip + 1] : "";
+        if (option == "--timeline" && argc > skip + 3) {
+            options.timeline_path = argv[skip + 2];
+            skip += 2;
+        } else if (option == "--results" && argc > skip + 4) {
+            options.results_format = argv[skip + 2];
+            options.results_path = argv[skip + 3];
+            skip += 3;
+        } else if (option == "--snapshot" && argc > skip + 4) {
+            options.snapshot_time = std::atoll(argv[skip + 2]);
+            options.snapshot_path = argv[skip + 3];
+            skip += 3;
+        } else if (option == "--resume" && argc > skip + 3) {
+            options.resume_path = argv[skip + 2];
+            skip += 2;
+        } else {
+            break;
+        }
+    }
+    if (argc > skip + 1) {
+        return runTrace(argc - skip, argv + skip, options);
+    }
+    
     std::cout << "CPU Scheduling Algorithms - Lab Assignment\n";
     
     // Part 2: Exercises
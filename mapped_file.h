@@ -0,0 +1,25 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <cstddef>
+
+// Read-only mapping of a whole file, unmapped on destruction.
+// Throws std::runtime_error if the file can't be opened or mapped.
+class MappedFile {
+private:
+    const char* data_;
+    size_t size_;
+    
+public:
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+    
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+};
+
+#endif
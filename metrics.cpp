@@ -0,0 +1,197 @@
+#include "metrics.h"
+#include "snapshot.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+
+// Latency histogram
+LatencyHistogram::LatencyHistogram() : counts(BUCKETS, 0) {
+    clear();
+}
+
+size_t LatencyHistogram::bucketOf(uint64_t value) {
+    if (value < SUB_COUNT) return value;
+    
+    // Keep the top SUB_BITS-1 bits below the leading one
+    int msb = 63 - __builtin_clzll(value);
+    int shift = msb - SUB_BITS + 1;
+    size_t mantissa = value >> shift;
+    return SUB_COUNT + (shift - 1) * HALF_COUNT + (mantissa - HALF_COUNT);
+}
+
+int64_t LatencyHistogram::bucketTop(size_t bucket) {
+    if (bucket < SUB_COUNT) return bucket;
+    
+    size_t offset = bucket - SUB_COUNT;
+    int shift = offset / HALF_COUNT + 1;
+    uint64_t mantissa = offset % HALF_COUNT + HALF_COUNT;
+    return static_cast<int64_t>(((mantissa + 1) << shift) - 1);
+}
+
+void LatencyHistogram::record(int64_t value) {
+    if (value < 0) value = 0;
+    counts[bucketOf(value)]++;
+    if (total == 0 || value < min_value) min_value = value;
+    if (total == 0 || value > max_value) max_value = value;
+    total++;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    if (other.total == 0) return;
+    for (size_t i = 0; i < BUCKETS; i++) counts[i] += other.counts[i];
+    min_value = total ? std::min(min_value, other.min_value) : other.min_value;
+    max_value = total ? std::max(max_value, other.max_value) : other.max_value;
+    total += other.total;
+}
+
+void LatencyHistogram::clear() {
+    std::fill(counts.begin(), counts.end(), 0);
+    total = 0;
+    min_value = 0;
+    max_value = 0;
+}
+
+void LatencyHistogram::save(SnapshotWriter& out) const {
+    out.putVector(counts);
+    out.put(total);
+    out.put(min_value);
+    out.put(max_value);
+}
+
+void LatencyHistogram::load(SnapshotReader& in) {
+    std::vector<uint64_t> loaded;
+    in.getVector(loaded);
+    if (loaded.size() != counts.size()) in.fail("histogram has a different bucket count");
+    counts.swap(loaded);
+    total = in.get<uint64_t>();
+    min_value = in.get<int64_t>();
+    max_value = in.get<int64_t>();
+}
+
+int64_t LatencyHistogram::percentile(double q) const {
+    if (total == 0) return 0;
+    
+    uint64_t rank = static_cast<uint64_t>(std::ceil(q * total));
+    rank = std::max<uint64_t>(1, std::min(rank, total));
+    
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKETS; i++) {
+        seen += counts[i];
+        if (seen >= rank) {
+            return std::max(min_value, std::min(bucketTop(i), max_value));
+        }
+    }
+    return max_value;
+}
+
+// Streaming metrics
+void StreamingMetrics::record(SimTime arrival, SimTime burst, SimTime completion, SimTime io) {
+    SimTime task_turnaround = completion - arrival;
+    SimTime task_waiting = task_turnaround - burst - io;
+    total_waiting += task_waiting;
+    total_turnaround += task_turnaround;
+    total_burst += burst;
+    min_arrival = std::min<int64_t>(min_arrival, arrival);
+    max_completion = std::max<int64_t>(max_completion, completion);
+    waiting.record(task_waiting);
+    turnaround.record(task_turnaround);
+    count++;
+}
+
+void StreamingMetrics::record(const TaskStore& tasks, const SimTime* io) {
+    for (size_t i = 0; i < tasks.size(); i++) {
+        record(tasks.arrivalTime(i), tasks.burstTime(i), tasks.completionTime(i),
+               io ? io[i] : 0);
+    }
+}
+
+void StreamingMetrics::merge(const StreamingMetrics& other) {
+    count += other.count;
+    total_waiting += other.total_waiting;
+    total_turnaround += other.total_turnaround;
+    total_burst += other.total_burst;
+    min_arrival = std::min(min_arrival, other.min_arrival);
+    max_completion = std::max(max_completion, other.max_completion);
+    waiting.merge(other.waiting);
+    turnaround.merge(other.turnaround);
+}
+
+void StreamingMetrics::clear() {
+    count = 0;
+    total_waiting = 0;
+    total_turnaround = 0;
+    total_burst = 0;
+    min_arrival = std::numeric_limits<int64_t>::max();
+    max_completion = 0;
+    waiting.clear();
+    turnaround.clear();
+}
+
+void StreamingMetrics::save(SnapshotWriter& out) const {
+    out.put(count);
+    out.put(total_waiting);
+    out.put(total_turnaround);
+    out.put(total_burst);
+    out.put(min_arrival);
+    out.put(max_completion);
+    waiting.save(out);
+    turnaround.save(out);
+}
+
+void StreamingMetrics::load(SnapshotReader& in) {
+    count = in.get<uint64_t>();
+    total_waiting = in.get<double>();
+    total_turnaround = in.get<double>();
+    total_burst = in.get<double>();
+    min_arrival = in.get<int64_t>();
+    max_completion = in.get<int64_t>();
+    waiting.load(in);
+    turnaround.load(in);
+}
+
+ScheduleMetrics StreamingMetrics::summary(int cpus) const {
+    ScheduleMetrics m;
+    // Nothing finished yet: all zeros rather than 0/0
+    if (count == 0) return m;
+    m.tasks = count;
+    m.avg_waiting = total_waiting / count;
+    m.avg_turnaround = total_turnaround / count;
+    m.span = max_completion - min_arrival;
+    if (m.span > 0) {
+        m.throughput = count / (double)m.span;
+        m.cpu_utilization = (total_burst / ((double)cpus * m.span)) * 100;
+    }
+    return m;
+}
+
+ScheduleMetrics computeMetrics(const TaskStore& tasks, int cpus) {
+    StreamingMetrics m;
+    m.record(tasks);
+    return m.summary(cpus);
+}
+
+void printPercentiles(const char* label, const LatencyHistogram& h) {
+    std::cout << label << " (min/p50/p90/p99/p99.9/max): "
+              << h.min() << " / " << h.percentile(0.50) << " / "
+              << h.percentile(0.90) << " / " << h.percentile(0.99) << " / "
+              << h.percentile(0.999) << " / " << h.max() << "\n";
+}
+
+void printLatencies(const StreamingMetrics& metrics) {
+    printPercentiles("Waiting Time", metrics.waitingTimes());
+    printPercentiles("Turnaround Time", metrics.turnaroundTimes());
+}
+
+ScheduleMetrics printPerformanceMetrics(const StreamingMetrics& metrics, int cpus) {
+    ScheduleMetrics m = metrics.summary(cpus);
+    std::cout << "\n--- Performance Metrics ---\n";
+    std::cout << "Average Waiting Time: " << std::fixed << std::setprecision(2) 
+              << m.avg_waiting << "\n";
+    std::cout << "Average Turnaround Time: " << m.avg_turnaround << "\n";
+    std::cout << "Throughput: " << m.throughput << " tasks/time unit\n";
+    std::cout << "CPU Utilization: " << m.cpu_utilization << "%\n";
+    printLatencies(metrics);
+    return m;
+}
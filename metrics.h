@@ -0,0 +1,117 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "task_store.h"
+
+class SnapshotWriter;
+class SnapshotReader;
+
+// Summary figures reported by TaskScheduler::printMetrics()
+struct ScheduleMetrics {
+    size_t tasks;
+    double avg_waiting;
+    double avg_turnaround;
+    double throughput;        // tasks per time unit
+    double cpu_utilization;   // percent of total capacity across all CPUs
+    SimTime span;             // first arrival to last completion
+    
+    ScheduleMetrics()
+        : tasks(0), avg_waiting(0), avg_turnaround(0), throughput(0),
+          cpu_utilization(0), span(0) {}
+};
+
+// Log-bucketed histogram of non-negative times in the style of HDR
+// histograms. Values below 2^SUB_BITS are exact; above that each power of
+// two is split into 2^(SUB_BITS-1) buckets, so a reported percentile is
+// within 1% of the true value. The bucket array has a fixed size whatever
+// the number or range of values recorded.
+class LatencyHistogram {
+public:
+    static const int SUB_BITS = 8;
+    
+private:
+    static const size_t SUB_COUNT = size_t(1) << SUB_BITS;
+    static const size_t HALF_COUNT = SUB_COUNT / 2;
+    static const size_t BUCKETS = SUB_COUNT + (63 - SUB_BITS) * HALF_COUNT;
+    
+    std::vector<uint64_t> counts;
+    uint64_t total;
+    int64_t min_value;
+    int64_t max_value;
+    
+    static size_t bucketOf(uint64_t value);
+    static int64_t bucketTop(size_t bucket);
+    
+public:
+    LatencyHistogram();
+    
+    // Negative values are recorded as 0
+    void record(int64_t value);
+    void merge(const LatencyHistogram& other);
+    void clear();
+    // Checkpoint support (see snapshot.h)
+    void save(SnapshotWriter& out) const;
+    void load(SnapshotReader& in);
+    
+    uint64_t count() const { return total; }
+    int64_t min() const { return total ? min_value : 0; }
+    int64_t max() const { return total ? max_value : 0; }
+    
+    // Value at quantile q in [0, 1]: the rank ceil(q * count) value, as the
+    // top of its bucket clamped to the recorded range
+    int64_t percentile(double q) const;
+};
+
+// Running summary of a schedule fed one completion at a time, so a long
+// trace needs no per-task storage for its report
+class StreamingMetrics {
+private:
+    uint64_t count;
+    double total_waiting;
+    double total_turnaround;
+    double total_burst;
+    int64_t min_arrival;
+    int64_t max_completion;
+    LatencyHistogram waiting;
+    LatencyHistogram turnaround;
+    
+public:
+    StreamingMetrics() { clear(); }
+    
+    // Waiting time is the turnaround less the burst and `io`, the time
+    // spent being served by I/O devices
+    void record(SimTime arrival, SimTime burst, SimTime completion, SimTime io = 0);
+    // Records every task of a completed run, with `io` as above by store
+    // index if not null
+    void record(const TaskStore& tasks, const SimTime* io = nullptr);
+    void merge(const StreamingMetrics& other);
+    void clear();
+    // Checkpoint support (see snapshot.h)
+    void save(SnapshotWriter& out) const;
+    void load(SnapshotReader& in);
+    
+    size_t tasks() const { return count; }
+    // All zeros until a task has completed; throughput and utilisation stay
+    // 0 over a zero-length span
+    ScheduleMetrics summary(int cpus = 1) const;
+    const LatencyHistogram& waitingTimes() const { return waiting; }
+    const LatencyHistogram& turnaroundTimes() const { return turnaround; }
+};
+
+// Computes the summary over a completed run on `cpus` CPUs
+ScheduleMetrics computeMetrics(const TaskStore& tasks, int cpus = 1);
+
+// Prints the "Performance Metrics" section of a report for a run on `cpus`
+// CPUs and returns the summary it printed
+ScheduleMetrics printPerformanceMetrics(const StreamingMetrics& metrics, int cpus = 1);
+
+// Prints min, p50, p90, p99, p99.9 and max of `h` on one line
+void printPercentiles(const char* label, const LatencyHistogram& h);
+
+// Prints min, p50, p90, p99, p99.9 and max waiting and turnaround times
+void printLatencies(const StreamingMetrics& metrics);
+
+#endif
@@ -0,0 +1,163 @@
+#include "replicate.h"
+#include "simulation.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+const double PI = 3.14159265358979323846;
+
+// P(|T| <= t) for Student's t with integer df (Abramowitz & Stegun 26.7.3-4)
+double studentCentral(double t, size_t df) {
+    double theta = std::atan(t / std::sqrt(static_cast<double>(df)));
+    double c2 = std::cos(theta) * std::cos(theta);
+    double s = std::sin(theta);
+    double sum = 0, term = 1;
+    if (df % 2 == 0) {
+        for (size_t k = 1; k <= (df - 2) / 2 && term > 1e-17; k++) {
+            sum += term;
+            term *= c2 * (2 * k - 1) / (2 * k);
+        }
+        return s * (sum + term);
+    }
+    if (df == 1) return 2 * theta / PI;
+    for (size_t k = 1; k <= (df - 3) / 2 && term > 1e-17; k++) {
+        sum += term;
+        term *= c2 * (2 * k) / (2 * k + 1);
+    }
+    return 2 / PI * (theta + s * std::cos(theta) * (sum + term));
+}
+
+// Runs one replica with the loop specialised for its policy
+struct ReplicaRunner {
+    EventSimulator& sim;
+    template <class Queue> void operator()(Queue& queue) { sim.run(queue); }
+};
+
+Estimate estimate(const std::vector<double>& samples, double critical) {
+    Estimate e;
+    size_t n = samples.size();
+    if (n == 0) return e;
+    double sum = 0;
+    for (size_t i = 0; i < n; i++) sum += samples[i];
+    e.mean = sum / n;
+    if (n < 2) return e;
+    double squares = 0;
+    for (size_t i = 0; i < n; i++) squares += (samples[i] - e.mean) * (samples[i] - e.mean);
+    e.stddev = std::sqrt(squares / (n - 1));
+    e.half_width = critical * e.stddev / std::sqrt(static_cast<double>(n));
+    return e;
+}
+
+}
+
+uint64_t replicaSeed(uint64_t base, size_t index) {
+    uint64_t z = base + (static_cast<uint64_t>(index) + 1) * 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+double studentCritical(double confidence, size_t df) {
+    if (df == 0 || confidence <= 0) return 0;
+    if (confidence >= 1) return HUGE_VAL;
+    double lo = 0, hi = 1;
+    while (studentCentral(hi, df) < confidence) {
+        lo = hi;
+        hi *= 2;
+    }
+    for (int i = 0; i < 100; i++) {
+        double mid = (lo + hi) / 2;
+        if (studentCentral(mid, df) < confidence) lo = mid;
+        else hi = mid;
+    }
+    return (lo + hi) / 2;
+}
+
+ReplicationResult replicate(const ReplicationOptions& options) {
+    if (!makeReadyQueue(options.algorithm, options.quantum)) {
+        throw std::invalid_argument("unknown algorithm: " + options.algorithm);
+    }
+    
+    unsigned threads = options.threads;
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min<size_t>(threads, std::max<size_t>(options.replicas, 1));
+    
+    ReplicationResult result;
+    result.replicas.resize(options.replicas);
+    std::atomic<size_t> next(0);
+    
+    auto worker = [&]() {
+        TaskStore store;
+        EventSimulator sim(store);
+        ReadyQueueSet queues(options.algorithm, options.quantum);
+        StreamingMetrics stream;
+        WorkloadSpec spec = options.workload;
+        
+        for (size_t i = next++; i < options.replicas; i = next++) {
+            spec.seed = replicaSeed(options.workload.seed, i);
+            generateWorkload(spec, store);
+            
+            ReplicaRunner run = { sim };
+            visitReadyQueue(queues, options.algorithm, run);
+            
+            stream.clear();
+            stream.record(store);
+            result.replicas[i] = stream.summary();
+        }
+    };
+    
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; t++) pool.push_back(std::thread(worker));
+    worker();
+    for (size_t t = 0; t < pool.size(); t++) pool[t].join();
+    
+    // Reduced serially in replica order so the sums never depend on threads
+    size_t n = result.replicas.size();
+    double critical = studentCritical(options.confidence, n > 1 ? n - 1 : 0);
+    std::vector<double> samples(n);
+    for (size_t i = 0; i < n; i++) samples[i] = result.replicas[i].avg_waiting;
+    result.waiting = estimate(samples, critical);
+    for (size_t i = 0; i < n; i++) samples[i] = result.replicas[i].avg_turnaround;
+    result.turnaround = estimate(samples, critical);
+    for (size_t i = 0; i < n; i++) samples[i] = result.replicas[i].throughput;
+    result.throughput = estimate(samples, critical);
+    for (size_t i = 0; i < n; i++) samples[i] = result.replicas[i].cpu_utilization;
+    result.utilization = estimate(samples, critical);
+    return result;
+}
+
+void printReplication(const ReplicationResult& result, const ReplicationOptions& options) {
+    std::ios::fmtflags flags = std::cout.flags();
+    std::streamsize precision = std::cout.precision();
+    
+    std::cout << "\n=== Replication: " << options.algorithm;
+    if (options.algorithm == "RR" || options.algorithm == "MLFQ" || options.algorithm == "CFS") {
+        std::cout << " (Q=" << options.quantum << ")";
+    }
+    std::cout << ", " << result.replicas.size() << " x " << options.workload.tasks << " tasks, "
+              << describeWorkload(options.workload) << ", load " << options.workload.load
+              << " ===\n";
+    std::cout << std::fixed << std::setprecision(0) << options.confidence * 100
+              << "% confidence intervals\n";
+    std::cout << "Metric\t\tMean\t+/-\tStd Dev\n";
+    std::cout << "--------------------------------------------------------\n";
+    
+    const char* names[] = { "Avg Waiting", "Avg Turnaround", "Throughput", "CPU Util (%)" };
+    const Estimate* estimates[] = { &result.waiting, &result.turnaround,
+                                    &result.throughput, &result.utilization };
+    for (int i = 0; i < 4; i++) {
+        std::cout << std::left << std::setw(16) << names[i] << std::right
+                  << std::setprecision(i == 2 ? 6 : 2)
+                  << estimates[i]->mean << "\t" << estimates[i]->half_width
+                  << "\t" << estimates[i]->stddev << "\n";
+    }
+    
+    std::cout.flags(flags);
+    std::cout.precision(precision);
+}
@@ -0,0 +1,57 @@
+#ifndef REPLICATE_H
+#define REPLICATE_H
+
+#include <string>
+#include <vector>
+#include "metrics.h"
+#include "workload_gen.h"
+
+struct ReplicationOptions {
+    WorkloadSpec workload;    // its seed is the base for every replica seed
+    std::string algorithm;
+    SimTime quantum;
+    size_t replicas;
+    double confidence;        // two-sided level of the intervals, e.g. 0.95
+    unsigned threads;         // 0 = one per hardware thread
+    
+    ReplicationOptions()
+        : algorithm("FCFS"), quantum(4), replicas(30), confidence(0.95), threads(0) {}
+};
+
+// Sample mean of one metric over the replicas, with the half-width of its
+// Student-t confidence interval
+struct Estimate {
+    double mean;
+    double stddev;
+    double half_width;
+    
+    Estimate() : mean(0), stddev(0), half_width(0) {}
+};
+
+struct ReplicationResult {
+    Estimate waiting;
+    Estimate turnaround;
+    Estimate throughput;
+    Estimate utilization;
+    std::vector<ScheduleMetrics> replicas;   // by replica index
+};
+
+// Seed of replica `index`: a SplitMix64 step from the base seed, so replica
+// workloads are independent of each other and of how they are scheduled
+uint64_t replicaSeed(uint64_t base, size_t index);
+
+// Generates `replicas` workloads from the spec, one per replica seed, and
+// simulates them with the algorithm on a pool of worker threads. Each
+// worker keeps one store, simulator and set of queues for every replica it
+// takes. Per-replica results are kept by index and reduced in index order,
+// so the output is bit-identical for any thread count.
+// Throws std::invalid_argument for an unknown algorithm.
+ReplicationResult replicate(const ReplicationOptions& options);
+
+// Two-sided Student-t critical value: P(|T| <= t) = confidence with `df`
+// degrees of freedom
+double studentCritical(double confidence, size_t df);
+
+void printReplication(const ReplicationResult& result, const ReplicationOptions& options);
+
+#endif
@@ -0,0 +1,288 @@
+#include "results.h"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+const char RESULT_MAGIC[8] = { 'L', 'A', 'B', 'R', 'S', 'L', 'T', 'S' };
+
+// "00" to "99", so integers are formatted two digits at a time
+const char DIGIT_PAIRS[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+bool littleEndian() {
+    uint16_t probe = 1;
+    return *reinterpret_cast<const unsigned char*>(&probe) == 1;
+}
+
+SimTime turnaround(const TaskStore& t, size_t i) {
+    return t.completionTime(i) - t.arrivalTime(i);
+}
+
+}
+
+SimTime ResultSink::waitingTime(const TaskStore& tasks, size_t i) const {
+    SimTime waiting = turnaround(tasks, i) - tasks.burstTime(i);
+    return io_time ? waiting - io_time[i] : waiting;
+}
+
+// Output buffer
+OutputBuffer::OutputBuffer(int descriptor)
+    : fd(descriptor), owned(false), path("<fd " + std::to_string(descriptor) + ">"),
+      buffer(CAPACITY), used(0) {}
+
+OutputBuffer::OutputBuffer(const std::string& p)
+    : fd(1), owned(false), path(p), buffer(CAPACITY), used(0) {
+    if (p != "-") {
+        fd = ::open(p.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) throw std::runtime_error("cannot create " + p);
+        owned = true;
+    }
+}
+
+OutputBuffer::~OutputBuffer() {
+    try {
+        flush();
+    } catch (const std::runtime_error&) {
+        // Destructors can't report it; call flush() to see write errors
+    }
+    if (owned) ::close(fd);
+}
+
+void OutputBuffer::drain(const char* data, size_t bytes) {
+    while (bytes > 0) {
+        ssize_t n = ::write(fd, data, bytes);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error("write failed: " + path + ": " + std::strerror(errno));
+        }
+        data += n;
+        bytes -= n;
+    }
+}
+
+void OutputBuffer::flush() {
+    size_t pending = used;
+    used = 0;
+    drain(buffer.data(), pending);
+}
+
+void OutputBuffer::put(const char* text, size_t bytes) {
+    if (bytes > buffer.size() - used) {
+        flush();
+        if (bytes > buffer.size()) {
+            drain(text, bytes);
+            return;
+        }
+    }
+    std::memcpy(buffer.data() + used, text, bytes);
+    used += bytes;
+}
+
+void OutputBuffer::put(const char* text) {
+    put(text, std::strlen(text));
+}
+
+void OutputBuffer::putInt(int64_t value) {
+    if (buffer.size() - used < 20) flush();
+    char* p = buffer.data() + used;
+    uint64_t v = static_cast<uint64_t>(value);
+    if (value < 0) {
+        *p++ = '-';
+        v = ~v + 1;
+    }
+
+    // Digits are produced backwards into a scratch array, then copied
+    char digits[20];
+    char* end = digits + sizeof(digits);
+    char* d = end;
+    while (v >= 100) {
+        const char* pair = DIGIT_PAIRS + (v % 100) * 2;
+        v /= 100;
+        *--d = pair[1];
+        *--d = pair[0];
+    }
+    if (v >= 10) {
+        *--d = DIGIT_PAIRS[v * 2 + 1];
+        *--d = DIGIT_PAIRS[v * 2];
+    } else {
+        *--d = static_cast<char>('0' + v);
+    }
+    std::memcpy(p, d, end - d);
+    used = (p - buffer.data()) + (end - d);
+}
+
+// Sinks
+void ResultSink::finish() {
+    if (!started) {
+        header();
+        started = true;
+    }
+    footer();
+    out.flush();
+}
+
+void TableSink::header() {
+    if (layout == TABLE_PROCESSES) {
+        out.put("\nProcess\tArrival\tBurst\tCompletion\tTurnaround\tWaiting\n");
+        out.put("---------------------------------------------------------------\n");
+    } else {
+        out.put("Task\tArrival\tBurst\tPriority\tStart\tCompletion\tTurnaround\tWaiting\n");
+        out.put("--------------------------------------------------------------------------------\n");
+    }
+}
+
+void TableSink::row(const TaskStore& tasks, size_t i) {
+    if (layout == TABLE_PROCESSES) {
+        out.put('P');
+        out.putInt(tasks.taskId(i));
+        out.put('\t');
+        out.putInt(tasks.arrivalTime(i));
+        out.put('\t');
+        out.putInt(tasks.burstTime(i));
+        out.put('\t');
+        out.putInt(tasks.completionTime(i));
+        out.put("\t\t", 2);
+        out.putInt(turnaround(tasks, i));
+        out.put("\t\t", 2);
+        out.putInt(waitingTime(tasks, i));
+        out.put('\n');
+        return;
+    }
+
+    out.put('T');
+    out.putInt(tasks.taskId(i));
+    out.put('\t');
+    out.putInt(tasks.arrivalTime(i));
+    out.put('\t');
+    out.putInt(tasks.burstTime(i));
+    out.put('\t');
+    out.putInt(tasks.priority(i));
+    out.put("\t\t", 2);
+    out.putInt(tasks.startTime(i));
+    out.put('\t');
+    out.putInt(tasks.completionTime(i));
+    out.put("\t\t", 2);
+    out.putInt(turnaround(tasks, i));
+    out.put("\t\t", 2);
+    out.putInt(waitingTime(tasks, i));
+    out.put('\n');
+}
+
+void CsvSink::header() {
+    out.put("task_id,arrival,burst,priority,start,completion,turnaround,waiting\n");
+}
+
+void CsvSink::row(const TaskStore& tasks, size_t i) {
+    out.putInt(tasks.taskId(i));
+    out.put(',');
+    out.putInt(tasks.arrivalTime(i));
+    out.put(',');
+    out.putInt(tasks.burstTime(i));
+    out.put(',');
+    out.putInt(tasks.priority(i));
+    out.put(',');
+    out.putInt(tasks.startTime(i));
+    out.put(',');
+    out.putInt(tasks.completionTime(i));
+    out.put(',');
+    out.putInt(turnaround(tasks, i));
+    out.put(',');
+    out.putInt(waitingTime(tasks, i));
+    out.put('\n');
+}
+
+void NdjsonSink::row(const TaskStore& tasks, size_t i) {
+    out.put("{\"task_id\":");
+    out.putInt(tasks.taskId(i));
+    out.put(",\"arrival\":");
+    out.putInt(tasks.arrivalTime(i));
+    out.put(",\"burst\":");
+    out.putInt(tasks.burstTime(i));
+    out.put(",\"priority\":");
+    out.putInt(tasks.priority(i));
+    out.put(",\"start\":");
+    out.putInt(tasks.startTime(i));
+    out.put(",\"completion\":");
+    out.putInt(tasks.completionTime(i));
+    out.put(",\"turnaround\":");
+    out.putInt(turnaround(tasks, i));
+    out.put(",\"waiting\":");
+    out.putInt(waitingTime(tasks, i));
+    out.put("}\n", 2);
+}
+
+BinarySink::BinarySink(OutputBuffer& out) : ResultSink(out) {
+    if (!littleEndian()) {
+        throw std::runtime_error("binary results require a little-endian host");
+    }
+    ids.reserve(RESULT_BLOCK_ROWS);
+    priorities.reserve(RESULT_BLOCK_ROWS);
+    for (int c = 0; c < 4; c++) columns[c].reserve(RESULT_BLOCK_ROWS);
+}
+
+void BinarySink::header() {
+    BinaryResultHeader h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, RESULT_MAGIC, sizeof(h.magic));
+    h.version = BINARY_RESULT_VERSION;
+    h.block_rows = RESULT_BLOCK_ROWS;
+    out.putBytes(&h, sizeof(h));
+}
+
+void BinarySink::row(const TaskStore& tasks, size_t i) {
+    ids.push_back(tasks.taskId(i));
+    priorities.push_back(tasks.priority(i));
+    columns[0].push_back(tasks.arrivalTime(i));
+    columns[1].push_back(tasks.burstTime(i));
+    columns[2].push_back(tasks.startTime(i));
+    columns[3].push_back(tasks.completionTime(i));
+    if (ids.size() == RESULT_BLOCK_ROWS) writeBlock();
+}
+
+void BinarySink::writeBlock() {
+    static const char zeros[8] = { 0 };
+    uint64_t rows = ids.size();
+    size_t pad = rows % 2 ? 4 : 0;
+    out.putBytes(&rows, sizeof(rows));
+    out.putBytes(ids.data(), rows * sizeof(int32_t));
+    out.putBytes(zeros, pad);
+    out.putBytes(priorities.data(), rows * sizeof(int32_t));
+    out.putBytes(zeros, pad);
+    for (int c = 0; c < 4; c++) {
+        out.putBytes(columns[c].data(), rows * sizeof(SimTime));
+        columns[c].clear();
+    }
+    ids.clear();
+    priorities.clear();
+}
+
+void BinarySink::footer() {
+    if (!ids.empty()) writeBlock();
+    uint64_t end = 0;
+    out.putBytes(&end, sizeof(end));
+}
+
+std::unique_ptr<ResultSink> makeResultSink(const std::string& format, OutputBuffer& out) {
+    std::unique_ptr<ResultSink> sink;
+    if (format == "table") {
+        sink.reset(new TableSink(out));
+    } else if (format == "csv") {
+        sink.reset(new CsvSink(out));
+    } else if (format == "ndjson") {
+        sink.reset(new NdjsonSink(out));
+    } else if (format == "binary") {
+        sink.reset(new BinarySink(out));
+    }
+    return sink;
+}
+
+void writeResults(const TaskStore& tasks, ResultSink& sink) {
+    for (size_t i = 0; i < tasks.size(); i++) sink.write(tasks, i);
+    sink.finish();
+}
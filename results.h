@@ -0,0 +1,173 @@
+#ifndef RESULTS_H
+#define RESULTS_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include "task_store.h"
+
+// Output to a file descriptor through one large buffer, so writing a
+// million rows takes a handful of write() calls. Integers are formatted
+// straight into the buffer.
+class OutputBuffer {
+private:
+    int fd;
+    bool owned;
+    std::string path;
+    std::vector<char> buffer;
+    size_t used;
+
+    void drain(const char* data, size_t bytes);
+
+public:
+    static const size_t CAPACITY = 1 << 20;
+
+    // Writes to an already open descriptor, e.g. 1 for stdout
+    explicit OutputBuffer(int descriptor);
+    // Creates or truncates the file; "-" is stdout.
+    // Throws std::runtime_error if it can't be created.
+    explicit OutputBuffer(const std::string& path);
+    ~OutputBuffer();
+
+    OutputBuffer(const OutputBuffer&) = delete;
+    OutputBuffer& operator=(const OutputBuffer&) = delete;
+
+    void put(char c) {
+        if (used == buffer.size()) flush();
+        buffer[used++] = c;
+    }
+    void put(const char* text, size_t bytes);
+    void put(const char* text);
+    void putInt(int64_t value);
+    // Raw bytes, e.g. binary columns
+    void putBytes(const void* data, size_t bytes) {
+        put(static_cast<const char*>(data), bytes);
+    }
+    // Throws std::runtime_error if the write fails
+    void flush();
+};
+
+// Destination for finished tasks. Rows may be written one at a time as
+// tasks complete (see TaskScheduler::streamResults) or all at once with
+// writeResults(); finish() ends the output and flushes it.
+class ResultSink {
+private:
+    bool started;
+    const SimTime* io_time;
+
+protected:
+    OutputBuffer& out;
+
+    // Turnaround less burst and any time spent doing I/O
+    SimTime waitingTime(const TaskStore& tasks, size_t i) const;
+
+    virtual void header() {}
+    virtual void row(const TaskStore& tasks, size_t i) = 0;
+    virtual void footer() {}
+
+public:
+    explicit ResultSink(OutputBuffer& o) : started(false), io_time(nullptr), out(o) {}
+    virtual ~ResultSink() = default;
+
+    // Per-task time served by I/O devices, by store index, that later rows
+    // leave out of waiting time; null (the default) for none
+    void excludeFromWaiting(const SimTime* column) { io_time = column; }
+
+    // Writes the finished task at store index i
+    void write(const TaskStore& tasks, size_t i) {
+        if (!started) {
+            header();
+            started = true;
+        }
+        row(tasks, i);
+    }
+    void finish();
+};
+
+// Column layout of the human-readable tables
+enum TableLayout {
+    TABLE_TASKS,       // TaskScheduler::printMetrics()
+    TABLE_PROCESSES    // Scheduler::printResults()
+};
+
+// The tab-separated table printed by the lab programs
+class TableSink : public ResultSink {
+private:
+    TableLayout layout;
+
+protected:
+    void header() override;
+    void row(const TaskStore& tasks, size_t i) override;
+
+public:
+    TableSink(OutputBuffer& out, TableLayout l = TABLE_TASKS) : ResultSink(out), layout(l) {}
+};
+
+// task_id,arrival,burst,priority,start,completion,turnaround,waiting
+class CsvSink : public ResultSink {
+protected:
+    void header() override;
+    void row(const TaskStore& tasks, size_t i) override;
+
+public:
+    explicit CsvSink(OutputBuffer& out) : ResultSink(out) {}
+};
+
+// One JSON object per line with the CSV fields
+class NdjsonSink : public ResultSink {
+protected:
+    void row(const TaskStore& tasks, size_t i) override;
+
+public:
+    explicit NdjsonSink(OutputBuffer& out) : ResultSink(out) {}
+};
+
+// Binary result layout (version 1, little-endian):
+//
+//   BinaryResultHeader                         32 bytes
+//   blocks of up to RESULT_BLOCK_ROWS rows:
+//     uint64 rows
+//     id column          int32[rows]           padded to 8 bytes
+//     priority column    int32[rows]           padded to 8 bytes
+//     arrival, burst, start and completion columns, int64[rows] each
+//   uint64 0                                   end marker
+//
+// Blocks let rows be streamed as they complete while each block stays
+// columnar.
+const uint32_t BINARY_RESULT_VERSION = 1;
+const uint32_t RESULT_BLOCK_ROWS = 4096;
+
+struct BinaryResultHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t block_rows;
+    uint64_t reserved[2];
+};
+
+class BinarySink : public ResultSink {
+private:
+    std::vector<int32_t> ids;
+    std::vector<int32_t> priorities;
+    std::vector<SimTime> columns[4];
+
+    void writeBlock();
+
+protected:
+    void header() override;
+    void row(const TaskStore& tasks, size_t i) override;
+    void footer() override;
+
+public:
+    // Throws std::runtime_error on a big-endian host
+    explicit BinarySink(OutputBuffer& out);
+};
+
+// Parses "table", "csv", "ndjson" or "binary"; null if the name is unknown
+std::unique_ptr<ResultSink> makeResultSink(const std::string& format, OutputBuffer& out);
+
+// Writes every task of a completed run in store order, then finishes
+void writeResults(const TaskStore& tasks, ResultSink& sink);
+
+#endif
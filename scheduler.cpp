@@ -1,493 +1,276 @@
 #include "scheduler.h"
 #include <iostream>
 #include <algorithm>
-#include <iomanip>
-#include <climits>
+#include <stdexcept>
 
 // Base Scheduler methods
-void Scheduler::calculateMetrics() {
-    for (auto& p : processes) {
-        p.turnaround_time = p.completion_time - p.arrival_time;
-        p.waiting_time = p.turnaround_time - p.burst_time;
-    }
-}
-
 void Scheduler::printResults() const {
-    std::cout << "\nProcess\tArrival\tBurst\tCompletion\tTurnaround\tWaiting\n";
-    std::cout << "---------------------------------------------------------------\n";
+    // The table goes straight to stdout after whatever cout still holds
+    std::cout.flush();
+    {
+        OutputBuffer out(1);
+        TableSink table(out, TABLE_PROCESSES);
+        writeResults(table);
+    }
     
+    const SimTime* io_time = ioTimes(io, io_stats, processes.size());
     double total_waiting = 0, total_turnaround = 0;
-    
-    for (const auto& p : processes) {
-        std::cout << "P" << p.pid << "\t" 
-                  << p.arrival_time << "\t"
-                  << p.burst_time << "\t"
-                  << p.completion_time << "\t\t"
-                  << p.turnaround_time << "\t\t"
-                  << p.waiting_time << "\n";
-        total_waiting += p.waiting_time;
-        total_turnaround += p.turnaround_time;
+    for (size_t i = 0; i < processes.size(); i++) {
+        SimTime turnaround = processes.completionTime(i) - processes.arrivalTime(i);
+        total_waiting += turnaround - processes.burstTime(i) - (io_time ? io_time[i] : 0);
+        total_turnaround += turnaround;
     }
     
     std::cout << "\nAverage Waiting Time: " 
               << total_waiting / processes.size() << "\n";
     std::cout << "Average Turnaround Time: " 
               << total_turnaround / processes.size() << "\n";
+    
+    StreamingMetrics stream;
+    stream.record(processes, io_time);
+    printLatencies(stream);
+    
+    if (!io.empty()) {
+        printIoStats(io_stats, stream.summary().span);
+    } else if (cpu_count > 1) {
+        printCoreStats(core_stats, stream.summary(cpu_count).span);
+    }
+}
+
+TraceLoadStats Scheduler::loadTrace(const std::string& path) {
+    return ::loadTrace(path, processes);
+}
+
+// Multi-CPU runs clone the policy per core, so they stay on ReadyQueue
+void Scheduler::simulateSmp(const ReadyQueue& queue) {
+    SmpSimulator smp(processes, cpu_count);
+    smp.recordTimeline(timeline);
+    smp.run(queue);
+    current_time = smp.now();
+    dispatch_count = smp.dispatches();
+    core_stats = smp.coreStats();
+    counts = smp.counters();
+}
+
+void Scheduler::simulateIo(const ReadyQueue& queue) {
+    if (cpu_count > 1) {
+        throw std::invalid_argument("I/O phases need a single CPU");
+    }
+    IoSimulator sim(processes, io);
+    sim.recordTimeline(timeline);
+    sim.run(queue);
+    current_time = sim.now();
+    dispatch_count = sim.dispatches();
+    counts = sim.counters();
+    io_stats = sim.ioStats();
+}
+
+void Scheduler::writeResults(ResultSink& sink) const {
+    sink.excludeFromWaiting(ioTimes(io, io_stats, processes.size()));
+    ::writeResults(processes, sink);
+    sink.excludeFromWaiting(nullptr);
+}
+
+void Scheduler::reportCounters() const {
+    writeCountersJson(counts, name(), std::cerr);
 }
 
 // Exercise 1: FCFS Implementation
 void FCFSScheduler::schedule() {
-    std::sort(processes.begin(), processes.end(), 
-              [](const Process& a, const Process& b) {
-                  return a.arrival_time < b.arrival_time;
-              });
-    
-    current_time = 0;
-    for (auto& p : processes) {
-        if (current_time < p.arrival_time) {
-            current_time = p.arrival_time;
-        }
-        current_time += p.burst_time;
-        p.completion_time = current_time;
-    }
-    
-    calculateMetrics();
+    sortByArrival(processes, io);
+    simulate(queue);
 }
 
 // Exercise 2: SJF Non-Preemptive Implementation
 void SJFScheduler::schedule() {
-    std::vector<bool> completed(processes.size(), false);
-    current_time = 0;
-    int completed_count = 0;
-    
-    while (completed_count < processes.size()) {
-        int idx = -1;
-        int min_burst = INT_MAX;
-        
-        for (int i = 0; i < processes.size(); i++) {
-            if (!completed[i] && processes[i].arrival_time <= current_time) {
-                if (processes[i].burst_time < min_burst) {
-                    min_burst = processes[i].burst_time;
-                    idx = i;
-                }
-            }
-        }
-        
-        if (idx != -1) {
-            current_time += processes[idx].burst_time;
-            processes[idx].completion_time = current_time;
-            completed[idx] = true;
-            completed_count++;
-        } else {
-            current_time++;
-        }
-    }
-    
-    calculateMetrics();
+    simulate(queue);
 }
 
 // Exercise 3: SRTF Preemptive Implementation
 void SRTFScheduler::schedule() {
-    current_time = 0;
-    int completed = 0;
-    int n = processes.size();
-    std::vector<int> remaining_time(n);
-    
-    for (int i = 0; i < n; i++) {
-        remaining_time[i] = processes[i].burst_time;
-    }
-    
-    while (completed < n) {
-        int idx = -1;
-        int min_remaining = INT_MAX;
-        
-        for (int i = 0; i < n; i++) {
-            if (processes[i].arrival_time <= current_time && 
-                remaining_time[i] > 0 && 
-                remaining_time[i] < min_remaining) {
-                min_remaining = remaining_time[i];
-                idx = i;
-            }
-        }
-        
-        if (idx != -1) {
-            remaining_time[idx]--;
-            current_time++;
-            
-            if (remaining_time[idx] == 0) {
-                processes[idx].completion_time = current_time;
-                completed++;
-            }
-        } else {
-            current_time++;
-        }
-    }
-    
-    calculateMetrics();
+    simulate(queue);
 }
 
 // Exercise 4: Round Robin Non-Preemptive
 void RRNonPreemptiveScheduler::schedule() {
-    std::queue<int> ready_queue;
-    std::vector<bool> in_queue(processes.size(), false);
-    current_time = 0;
-    int completed = 0;
-    
-    // Sort by arrival time
-    std::vector<int> indices(processes.size());
-    for (int i = 0; i < processes.size(); i++) indices[i] = i;
-    std::sort(indices.begin(), indices.end(), 
-              [this](int a, int b) {
-                  return processes[a].arrival_time < processes[b].arrival_time;
-              });
-    
-    int next_process = 0;
-    
-    while (completed < processes.size()) {
-        // Newly arrived processes
-        while (next_process < processes.size() && 
-               processes[indices[next_process]].arrival_time <= current_time) {
-            if (!in_queue[indices[next_process]] && 
-                processes[indices[next_process]].remaining_time > 0) {
-                ready_queue.push(indices[next_process]);
-                in_queue[indices[next_process]] = true;
-            }
-            next_process++;
-        }
-        
-        if (!ready_queue.empty()) {
-            int idx = ready_queue.front();
-            ready_queue.pop();
-            in_queue[idx] = false;
-            
-            int exec_time = std::min(quantum, processes[idx].remaining_time);
-            current_time += exec_time;
-            processes[idx].remaining_time -= exec_time;
-            
-            // Newly arrived processes during execution
-            while (next_process < processes.size() && 
-                   processes[indices[next_process]].arrival_time <= current_time) {
-                if (!in_queue[indices[next_process]] && 
-                    processes[indices[next_process]].remaining_time > 0) {
-                    ready_queue.push(indices[next_process]);
-                    in_queue[indices[next_process]] = true;
-                }
-                next_process++;
-            }
-            
-            if (processes[idx].remaining_time > 0) {
-                ready_queue.push(idx);
-                in_queue[idx] = true;
-            } else {
-                processes[idx].completion_time = current_time;
-                completed++;
-            }
-        } else {
-            current_time++;
-        }
-    }
-    
-    calculateMetrics();
+    simulate(queue);
 }
 
 // Exercise 5: Round Robin Scheduler
 void RoundRobinScheduler::schedule() {
-    std::queue<int> ready_queue;
-    std::vector<bool> in_queue(processes.size(), false);
-    current_time = 0;
-    int completed = 0;
-    
-    std::vector<int> indices(processes.size());
-    for (int i = 0; i < processes.size(); i++) indices[i] = i;
-    std::sort(indices.begin(), indices.end(), 
-              [this](int a, int b) {
-                  return processes[a].arrival_time < processes[b].arrival_time;
-              });
-    
-    int next_process = 0;
-    
-    while (completed < processes.size()) {
-        while (next_process < processes.size() && 
-               processes[indices[next_process]].arrival_time <= current_time) {
-            if (!in_queue[indices[next_process]] && 
-                processes[indices[next_process]].remaining_time > 0) {
-                ready_queue.push(indices[next_process]);
-                in_queue[indices[next_process]] = true;
-            }
-            next_process++;
-        }
-        
-        if (!ready_queue.empty()) {
-            int idx = ready_queue.front();
-            ready_queue.pop();
-            in_queue[idx] = false;
-            
-            int exec_time = std::min(quantum, processes[idx].remaining_time);
-            current_time += exec_time;
-            processes[idx].remaining_time -= exec_time;
-            
-            while (next_process < processes.size() && 
-                   processes[indices[next_process]].arrival_time <= current_time) {
-                if (!in_queue[indices[next_process]] && 
-                    processes[indices[next_process]].remaining_time > 0) {
-                    ready_queue.push(indices[next_process]);
-                    in_queue[indices[next_process]] = true;
-                }
-                next_process++;
-            }
-            
-            if (processes[idx].remaining_time > 0) {
-                ready_queue.push(idx);
-                in_queue[idx] = true;
-            } else {
-                processes[idx].completion_time = current_time;
-                completed++;
-            }
-        } else {
-            current_time++;
-        }
-    }
-    
-    calculateMetrics();
+    simulate(queue);
 }
 
 // Part 3: Task Scheduler Implementation
 void TaskScheduler::run() {
+    online.reset();
+    online_queue.reset();
+    if ((cpu_count > 1 || !io.empty()) && (snapshot_time >= 0 || !resume_path.empty())) {
+        snapshot_time = -1;
+        resume_path.clear();
+        throw std::invalid_argument(cpu_count > 1 ? "snapshots need a single CPU"
+                                                  : "snapshots need tasks without I/O");
+    }
+    
+    // FCFS also lists its results in arrival order
     if (algorithm == "FCFS") {
-        scheduleFCFS();
-    } else if (algorithm == "SJF") {
-        scheduleSJF();
-    } else if (algorithm == "SRTF") {
-        scheduleSRTF();
-    } else if (algorithm == "RR") {
-        scheduleRR();
-    } else if (algorithm == "Priority") {
-        schedulePriority();
+        sortByArrival(tasks, io);
+    }
+    // Only the policy in use is configured, so a quantum of 0 is fine for
+    // the policies without one
+    if (algorithm == "RR") {
+        queues.rr.setQuantum(quantum);
+    } else if (algorithm == "MLFQ") {
+        queues.mlfq.configure(mlfq);
+    } else if (algorithm == "CFS") {
+        queues.cfs.configure(fair);
+    }
+    Runner runner = { *this };
+    if (!visitReadyQueue(queues, algorithm, runner)) {
+        throw std::invalid_argument("unknown algorithm: " + algorithm);
     }
 }
 
-void TaskScheduler::scheduleFCFS() {
-    std::sort(tasks.begin(), tasks.end(), 
-              [](const Task& a, const Task& b) {
-                  return a.arrival_time < b.arrival_time;
-              });
-    
-    current_time = 0;
-    for (auto& t : tasks) {
-        if (current_time < t.arrival_time) {
-            current_time = t.arrival_time;
-        }
-        t.start_time = current_time;
-        current_time += t.burst_time;
-        t.completion_time = current_time;
-        t.turnaround_time = t.completion_time - t.arrival_time;
-        t.waiting_time = t.turnaround_time - t.burst_time;
+void TaskScheduler::resume(const std::string& path) {
+    resume_path = path;
+    try {
+        run();
+    } catch (...) {
+        resume_path.clear();
+        throw;
     }
+    resume_path.clear();
 }
 
-void TaskScheduler::scheduleSJF() {
-    std::vector<bool> completed(tasks.size(), false);
-    current_time = 0;
-    int completed_count = 0;
-    
-    while (completed_count < tasks.size()) {
-        int idx = -1;
-        int min_burst = INT_MAX;
-        
-        for (int i = 0; i < tasks.size(); i++) {
-            if (!completed[i] && tasks[i].arrival_time <= current_time) {
-                if (tasks[i].burst_time < min_burst) {
-                    min_burst = tasks[i].burst_time;
-                    idx = i;
-                }
-            }
-        }
-        
-        if (idx != -1) {
-            tasks[idx].start_time = current_time;
-            current_time += tasks[idx].burst_time;
-            tasks[idx].completion_time = current_time;
-            tasks[idx].turnaround_time = tasks[idx].completion_time - tasks[idx].arrival_time;
-            tasks[idx].waiting_time = tasks[idx].turnaround_time - tasks[idx].burst_time;
-            completed[idx] = true;
-            completed_count++;
-        } else {
-            current_time++;
-        }
+TraceLoadStats TaskScheduler::loadTrace(const std::string& path) {
+    return ::loadTrace(path, tasks);
+}
+
+// Multi-CPU runs clone the policy per core, so they stay on ReadyQueue
+void TaskScheduler::simulateSmp(const ReadyQueue& queue) {
+    SmpSimulator smp(tasks, cpu_count);
+    smp.recordTimeline(timeline);
+    smp.streamTo(results);
+    smp.run(queue);
+    current_time = smp.now();
+    dispatch_count = smp.dispatches();
+    core_stats = smp.coreStats();
+    counts = smp.counters();
+}
+
+void TaskScheduler::simulateIo(const ReadyQueue& queue) {
+    if (cpu_count > 1) {
+        throw std::invalid_argument("I/O phases need a single CPU");
     }
+    IoSimulator sim(tasks, io);
+    sim.recordTimeline(timeline);
+    sim.streamTo(results);
+    sim.run(queue);
+    current_time = sim.now();
+    dispatch_count = sim.dispatches();
+    counts = sim.counters();
+    io_stats = sim.ioStats();
 }
 
-void TaskScheduler::scheduleSRTF() {
-    current_time = 0;
-    int completed = 0;
-    int n = tasks.size();
-    
-    while (completed < n) {
-        int idx = -1;
-        int min_remaining = INT_MAX;
-        
-        for (int i = 0; i < n; i++) {
-            if (tasks[i].arrival_time <= current_time && 
-                tasks[i].remaining_time > 0 && 
-                tasks[i].remaining_time < min_remaining) {
-                min_remaining = tasks[i].remaining_time;
-                idx = i;
-            }
-        }
-        
-        if (idx != -1) {
-            if (!tasks[idx].started) {
-                tasks[idx].start_time = current_time;
-                tasks[idx].started = true;
-            }
-            
-            tasks[idx].remaining_time--;
-            current_time++;
-            
-            if (tasks[idx].remaining_time == 0) {
-                tasks[idx].completion_time = current_time;
-                tasks[idx].turnaround_time = tasks[idx].completion_time - tasks[idx].arrival_time;
-                tasks[idx].waiting_time = tasks[idx].turnaround_time - tasks[idx].burst_time;
-                completed++;
-            }
-        } else {
-            current_time++;
-        }
+void TaskScheduler::writeResults(ResultSink& sink) const {
+    sink.excludeFromWaiting(ioTimes(io, io_stats, tasks.size()));
+    ::writeResults(tasks, sink);
+    sink.excludeFromWaiting(nullptr);
+}
+
+void TaskScheduler::reportCounters() const {
+    writeCountersJson(counts, algorithm, std::cerr);
+}
+
+void TaskScheduler::startOnline() {
+    if (algorithm == "MLFQ") {
+        online_queue.reset(new MlfqQueue(mlfq));
+    } else if (algorithm == "CFS") {
+        online_queue.reset(new FairQueue(fair));
+    } else {
+        online_queue = makeReadyQueue(algorithm, quantum);
     }
+    if (!online_queue) {
+        throw std::invalid_argument("unknown algorithm: " + algorithm);
+    }
+    online.reset(new EventSimulator(tasks));
+    online->recordTimeline(timeline);
+    online->start(*online_queue);
+    online_metrics.clear();
+    online->recordInto(&online_metrics);
+    online->streamTo(results);
 }
 
-void TaskScheduler::scheduleRR() {
-    std::queue<int> ready_queue;
-    std::vector<bool> in_queue(tasks.size(), false);
-    current_time = 0;
-    int completed = 0;
-    
-    std::vector<int> indices(tasks.size());
-    for (int i = 0; i < tasks.size(); i++) indices[i] = i;
-    std::sort(indices.begin(), indices.end(), 
-              [this](int a, int b) {
-                  return tasks[a].arrival_time < tasks[b].arrival_time;
-              });
-    
-    int next_task = 0;
-    
-    while (completed < tasks.size()) {
-        while (next_task < tasks.size() && 
-               tasks[indices[next_task]].arrival_time <= current_time) {
-            if (!in_queue[indices[next_task]] && 
-                tasks[indices[next_task]].remaining_time > 0) {
-                ready_queue.push(indices[next_task]);
-                in_queue[indices[next_task]] = true;
-            }
-            next_task++;
-        }
-        
-        if (!ready_queue.empty()) {
-            int idx = ready_queue.front();
-            ready_queue.pop();
-            in_queue[idx] = false;
-            
-            if (!tasks[idx].started) {
-                tasks[idx].start_time = current_time;
-                tasks[idx].started = true;
-            }
-            
-            int exec_time = std::min(quantum, tasks[idx].remaining_time);
-            current_time += exec_time;
-            tasks[idx].remaining_time -= exec_time;
-            
-            while (next_task < tasks.size() && 
-                   tasks[indices[next_task]].arrival_time <= current_time) {
-                if (!in_queue[indices[next_task]] && 
-                    tasks[indices[next_task]].remaining_time > 0) {
-                    ready_queue.push(indices[next_task]);
-                    in_queue[indices[next_task]] = true;
-                }
-                next_task++;
-            }
-            
-            if (tasks[idx].remaining_time > 0) {
-                ready_queue.push(idx);
-                in_queue[idx] = true;
-            } else {
-                tasks[idx].completion_time = current_time;
-                tasks[idx].turnaround_time = tasks[idx].completion_time - tasks[idx].arrival_time;
-                tasks[idx].waiting_time = tasks[idx].turnaround_time - tasks[idx].burst_time;
-                completed++;
-            }
-        } else {
-            current_time++;
-        }
+void TaskScheduler::submit(const Task& t) {
+    if (!t.io.empty()) {
+        throw std::invalid_argument("online tasks cannot have I/O phases");
     }
+    if (!online) startOnline();
+    online->submit(t.task_id, t.arrival_time, t.burst_time, t.priority);
 }
 
-void TaskScheduler::schedulePriority() {
-    std::vector<bool> completed(tasks.size(), false);
-    current_time = 0;
-    int completed_count = 0;
+void TaskScheduler::advanceUntil(SimTime time) {
+    if (!online) startOnline();
+    online->advanceUntil(time);
+    current_time = online->now();
+    dispatch_count = online->dispatches();
+}
+
+size_t TaskScheduler::advanceEvents(size_t count) {
+    if (!online) startOnline();
+    size_t delivered = online->advanceEvents(count);
+    current_time = online->now();
+    dispatch_count = online->dispatches();
+    return delivered;
+}
+
+std::vector<TaskCompletion> TaskScheduler::drainCompletions() {
+    std::vector<TaskCompletion> done;
+    if (!online) return done;
     
-    while (completed_count < tasks.size()) {
-        int idx = -1;
-        int highest_priority = INT_MAX;
-        
-        for (int i = 0; i < tasks.size(); i++) {
-            if (!completed[i] && tasks[i].arrival_time <= current_time) {
-                if (tasks[i].priority < highest_priority) {
-                    highest_priority = tasks[i].priority;
-                    idx = i;
-                }
-            }
-        }
-        
-        if (idx != -1) {
-            tasks[idx].start_time = current_time;
-            current_time += tasks[idx].burst_time;
-            tasks[idx].completion_time = current_time;
-            tasks[idx].turnaround_time = tasks[idx].completion_time - tasks[idx].arrival_time;
-            tasks[idx].waiting_time = tasks[idx].turnaround_time - tasks[idx].burst_time;
-            completed[idx] = true;
-            completed_count++;
-        } else {
-            current_time++;
-        }
+    drained.clear();
+    online->drainCompletions(drained);
+    done.reserve(drained.size());
+    for (size_t k = 0; k < drained.size(); k++) {
+        int i = drained[k];
+        TaskCompletion c;
+        c.task_id = tasks.taskId(i);
+        c.arrival_time = tasks.arrivalTime(i);
+        c.burst_time = tasks.burstTime(i);
+        c.priority = tasks.priority(i);
+        c.start_time = tasks.startTime(i);
+        c.completion_time = tasks.completionTime(i);
+        c.turnaround_time = c.completion_time - c.arrival_time;
+        c.waiting_time = c.turnaround_time - c.burst_time;
+        done.push_back(c);
     }
+    return done;
 }
 
 void TaskScheduler::printMetrics() const {
     std::cout << "\n=== Task Scheduler Results (" << algorithm << ") ===\n";
-    std::cout << "Task\tArrival\tBurst\tPriority\tStart\tCompletion\tTurnaround\tWaiting\n";
-    std::cout << "--------------------------------------------------------------------------------\n";
-    
-    double total_waiting = 0, total_turnaround = 0;
-    double total_burst = 0;
-    int min_arrival = INT_MAX, max_completion = 0;
-    
-    for (const auto& t : tasks) {
-        std::cout << "T" << t.task_id << "\t"
-                  << t.arrival_time << "\t"
-                  << t.burst_time << "\t"
-                  << t.priority << "\t\t"
-                  << t.start_time << "\t"
-                  << t.completion_time << "\t\t"
-                  << t.turnaround_time << "\t\t"
-                  << t.waiting_time << "\n";
-        
-        total_waiting += t.waiting_time;
-        total_turnaround += t.turnaround_time;
-        total_burst += t.burst_time;
-        min_arrival = std::min(min_arrival, t.arrival_time);
-        max_completion = std::max(max_completion, t.completion_time);
+    std::cout.flush();
+    {
+        OutputBuffer out(1);
+        TableSink table(out, TABLE_TASKS);
+        writeResults(table);
     }
+    printPerformance();
+}
+
+void TaskScheduler::printSummary() const {
+    std::cout << "\n=== Task Scheduler Results (" << algorithm << ") ===\n";
+    printPerformance();
+}
+
+void TaskScheduler::printPerformance() const {
+    StreamingMetrics stream;
+    stream.record(tasks, ioTimes(io, io_stats, tasks.size()));
+    ScheduleMetrics m = printPerformanceMetrics(stream, cpu_count);
     
-    double avg_waiting = total_waiting / tasks.size();
-    double avg_turnaround = total_turnaround / tasks.size();
-    double throughput = tasks.size() / (double)(max_completion - min_arrival);
-    double cpu_utilization = (total_burst / (max_completion - min_arrival)) * 100;
-    
-    std::cout << "\n--- Performance Metrics ---\n";
-    std::cout << "Average Waiting Time: " << std::fixed << std::setprecision(2) 
-              << avg_waiting << "\n";
-    std::cout << "Average Turnaround Time: " << avg_turnaround << "\n";
-    std::cout << "Throughput: " << throughput << " tasks/time unit\n";
-    std::cout << "CPU Utilization: " << cpu_utilization << "%\n";
+    if (!io.empty()) {
+        printIoStats(io_stats, m.span);
+    } else if (cpu_count > 1) {
+        printCoreStats(core_stats, m.span);
+    }
 }
\ No newline at end of file
@@ -5,119 +5,339 @@
 #include <vector>
 #include <queue>
 #include <memory>
+#include "simulation.h"
+#include "trace_loader.h"
+#include "metrics.h"
+#include "smp.h"
+#include "io_sim.h"
 
-// Process structure
+// Process structure: the inputs of one job. Results are kept in the
+// scheduler's TaskStore.
 struct Process {
     int pid;
-    int arrival_time;
-    int burst_time;
-    int remaining_time;
     int priority;
-    int waiting_time;
-    int turnaround_time;
-    int completion_time;
-    
-    Process(int p, int at, int bt, int pr = 0) 
-        : pid(p), arrival_time(at), burst_time(bt), 
-          remaining_time(bt), priority(pr), 
-          waiting_time(0), turnaround_time(0), completion_time(0) {}
+    SimTime arrival_time;
+    SimTime burst_time;
+    std::vector<IoPhase> io;    // I/O and CPU bursts after the first, if any
+    
+    Process(int p, SimTime at, SimTime bt, int pr = 0) 
+        : pid(p), priority(pr), arrival_time(at), burst_time(bt) {}
 };
 
-// Task structure
+// Task structure: the inputs of one task, as for Process
 struct Task {
     int task_id;
-    int arrival_time;
-    int burst_time;
     int priority;
-    int remaining_time;
-    int waiting_time;
-    int turnaround_time;
-    int completion_time;
-    int start_time;
-    bool started;
-    
-    Task(int id, int at, int bt, int pr = 0)
-        : task_id(id), arrival_time(at), burst_time(bt), priority(pr),
-          remaining_time(bt), waiting_time(0), turnaround_time(0),
-          completion_time(0), start_time(-1), started(false) {}
+    SimTime arrival_time;
+    SimTime burst_time;
+    std::vector<IoPhase> io;    // I/O and CPU bursts after the first, if any
+    
+    Task(int id, SimTime at, SimTime bt, int pr = 0)
+        : task_id(id), priority(pr), arrival_time(at), burst_time(bt) {}
+};
+
+// A finished task as reported by TaskScheduler::drainCompletions()
+struct TaskCompletion {
+    int task_id;
+    int priority;
+    SimTime arrival_time;
+    SimTime burst_time;
+    SimTime start_time;
+    SimTime completion_time;
+    SimTime turnaround_time;
+    SimTime waiting_time;
 };
 
 // Scheduler interface
 class Scheduler {
 protected:
-    std::vector<Process> processes;
-    int current_time;
+    TaskStore processes;
+    EventSimulator engine;    // kept so repeated runs reuse its buffers
+    SimTime current_time;
+    size_t dispatch_count;
+    int cpu_count;
+    std::vector<CoreStats> core_stats;
+    Timeline* timeline;
+    SchedulerCounters counts;
+    IoTable io;
+    IoStats io_stats;
+    
+    // Runs the processes through the shared simulation core, specialised
+    // for the concrete queue type
+    template <class Queue> void simulate(Queue& queue);
+    void simulateSmp(const ReadyQueue& queue);
+    void simulateIo(const ReadyQueue& queue);
+    void reportCounters() const;
     
 public:
-    Scheduler() : current_time(0) {}
+    Scheduler()
+        : engine(processes), current_time(0), dispatch_count(0), cpu_count(1),
+          timeline(nullptr) {}
     virtual ~Scheduler() = default;
     
+    // A process with I/O phases is simulated by IoSimulator, along with
+    // every other process; its burst column holds its total CPU time.
+    // Throws std::invalid_argument for a negative device or time.
     virtual void addProcess(const Process& p) {
-        processes.push_back(p);
+        if (!p.io.empty()) io.add(processes.size(), p.io);
+        processes.add(p.pid, p.arrival_time, cpuTime(p.burst_time, p.io), p.priority);
+    }
+    
+    // Appends every row of a text or binary trace (see trace_loader.h)
+    TraceLoadStats loadTrace(const std::string& path);
+    
+    // Runs over the workload's input columns in place; it must outlive us
+    void useWorkload(const TaskStore& workload) {
+        processes = workload.view();
+        io.clear();
     }
     
+    // Scheduling decisions made by the last schedule()
+    size_t dispatches() const { return dispatch_count; }
+    
+    // Dispatcher counters and phase timings of the last schedule(); all
+    // zero unless built with SCHED_STATS (make STATS=1), in which case
+    // every schedule() also writes them to stderr as JSON
+    const SchedulerCounters& counters() const { return counts; }
+    virtual const char* name() const { return "Scheduler"; }
+    
+    // Simulates `cpus` CPUs with per-CPU run queues and work stealing; not
+    // with I/O phases, where schedule() throws std::invalid_argument
+    void setCpus(int cpus) { cpu_count = cpus > 1 ? cpus : 1; }
+    
+    // Records later runs into `t` (see timeline.h); null stops recording
+    void recordTimeline(Timeline* t) { timeline = t; }
+    
+    // CPU, device and overlap figures of the last schedule() with I/O
+    const IoStats& ioStats() const { return io_stats; }
+    
     virtual void schedule() = 0;
+    // Prints the per-process table and averages
     virtual void printResults() const;
-    void calculateMetrics();
+    // Writes every process of the last schedule() to `sink` and finishes it;
+    // waiting time leaves out I/O
+    void writeResults(ResultSink& sink) const;
 };
 
 // FCFS Scheduler
 class FCFSScheduler : public Scheduler {
+private:
+    FifoQueue queue;
 public:
     void schedule() override;
+    const char* name() const override { return "FCFS"; }
 };
 
 // SJF Non-Preemptive Scheduler
 class SJFScheduler : public Scheduler {
+private:
+    KeyedQueue<BurstKey> queue;
 public:
     void schedule() override;
+    const char* name() const override { return "SJF"; }
 };
 
 // SRTF Preemptive Scheduler
 class SRTFScheduler : public Scheduler {
+private:
+    KeyedQueue<RemainingKey> queue;
 public:
     void schedule() override;
+    const char* name() const override { return "SRTF"; }
 };
 
 // Round Robin Non-Preemptive
 class RRNonPreemptiveScheduler : public Scheduler {
 private:
-    int quantum;
+    RoundRobinQueue queue;
 public:
-    RRNonPreemptiveScheduler(int q = 4) : quantum(q) {}
+    RRNonPreemptiveScheduler(SimTime q = 4) : queue(q) {}
     void schedule() override;
+    const char* name() const override { return "RR (non-preemptive)"; }
 };
 
 // Round Robin Scheduler
 class RoundRobinScheduler : public Scheduler {
 private:
-    int quantum;
+    RoundRobinQueue queue;
 public:
-    RoundRobinScheduler(int q) : quantum(q) {}
+    RoundRobinScheduler(SimTime q) : queue(q) {}
     void schedule() override;
+    const char* name() const override { return "RR"; }
 };
 
 // Comprehensive Task Scheduler
 class TaskScheduler {
 private:
-    std::vector<Task> tasks;
+    TaskStore tasks;
+    EventSimulator engine;    // kept so repeated runs reuse its buffers
+    ReadyQueueSet queues;
     std::string algorithm;
-    int quantum;
-    int current_time;
+    SimTime quantum;
+    SimTime current_time;
+    size_t dispatch_count;
+    int cpu_count;
+    std::vector<CoreStats> core_stats;
+    Timeline* timeline;
+    ResultSink* results;
+    SchedulerCounters counts;
+    MlfqConfig mlfq;
+    FairConfig fair;
+    IoTable io;
+    IoStats io_stats;
+    SimTime snapshot_time;    // -1 when no snapshot is wanted
+    std::string snapshot_path;
+    std::string resume_path;
+    
+    // Online session, opened by the first submit()
+    std::unique_ptr<ReadyQueue> online_queue;
+    std::unique_ptr<EventSimulator> online;
+    std::vector<int> drained;
+    StreamingMetrics online_metrics;
+    
+    // Hands run()'s statically typed queue to simulate()
+    struct Runner {
+        TaskScheduler& self;
+        template <class Queue> void operator()(Queue& queue) { self.simulate(queue); }
+    };
     
-    void scheduleFCFS();
-    void scheduleSJF();
-    void scheduleSRTF();
-    void scheduleRR();
-    void schedulePriority();
+    template <class Queue> void simulate(Queue& queue);
+    void simulateSmp(const ReadyQueue& queue);
+    void simulateIo(const ReadyQueue& queue);
+    void startOnline();
+    void printPerformance() const;
+    void reportCounters() const;
     
 public:
-    TaskScheduler(const std::string& algo, int q = 4) 
-        : algorithm(algo), quantum(q), current_time(0) {}
+    TaskScheduler(const std::string& algo, SimTime q = 4) 
+        : engine(tasks), algorithm(algo), quantum(q), current_time(0),
+          dispatch_count(0),
+          cpu_count(1), timeline(nullptr), results(nullptr), mlfq(MlfqConfig::geometric(3, q)),
+          fair(6 * q, q), snapshot_time(-1) {}
     
-    void addTask(const Task& t) { tasks.push_back(t); }
+    // As for Scheduler::addProcess
+    void addTask(const Task& t) {
+        if (!t.io.empty()) io.add(tasks.size(), t.io);
+        tasks.add(t.task_id, t.arrival_time, cpuTime(t.burst_time, t.io), t.priority);
+    }
+    
+    // Appends every row of a text or binary trace (see trace_loader.h)
+    TraceLoadStats loadTrace(const std::string& path);
+    
+    // Runs over the workload's input columns in place; it must outlive us
+    void useWorkload(const TaskStore& workload) {
+        tasks = workload.view();
+        io.clear();
+    }
+    
+    // Scheduling decisions made by the last run()
+    size_t dispatches() const { return dispatch_count; }
+    
+    // Dispatcher counters and phase timings of the last run() or the
+    // current online session; all zero unless built with SCHED_STATS (make
+    // STATS=1), in which case every run() also writes them to stderr as JSON
+    const SchedulerCounters& counters() const { return online ? online->counters() : counts; }
+    
+    // Simulates `cpus` CPUs with per-CPU run queues and work stealing; not
+    // with I/O phases, where run() throws std::invalid_argument
+    void setCpus(int cpus) { cpu_count = cpus > 1 ? cpus : 1; }
+    
+    // Records later runs into `t` (see timeline.h); null stops recording
+    void recordTimeline(Timeline* t) { timeline = t; }
+    
+    // CPU, device and overlap figures of the last run() with I/O
+    const IoStats& ioStats() const { return io_stats; }
+    
+    // Levels, quanta and boost period for "MLFQ"; the default is
+    // MlfqConfig::geometric(3, quantum)
+    void setMlfq(const MlfqConfig& config) { mlfq = config; }
+    
+    // Target latency and minimum granularity for "CFS"; the default is
+    // 6 * quantum and quantum
+    void setFair(const FairConfig& config) { fair = config; }
+    
+    // Writes each task to `sink` as it completes in later runs and online
+    // sessions; null stops it. The caller calls sink->finish() at the end.
+    void streamResults(ResultSink* sink) { results = sink; }
+    
+    // Throws std::invalid_argument for an unknown algorithm
     void run();
+    // Makes the next run() save its state at simulated time `time` to
+    // `path` (see EventSimulator::snapshotAt)
+    void snapshotAt(SimTime time, const std::string& path) {
+        snapshot_time = time;
+        snapshot_path = path;
+    }
+    // Like run(), but continues from a snapshot taken by a run of the same
+    // algorithm on the same tasks; the results match the uninterrupted run.
+    // Both need a single CPU and no I/O phases and throw
+    // std::invalid_argument otherwise; resume() throws std::runtime_error
+    // for a mismatched or bad snapshot.
+    void resume(const std::string& path);
+    // Prints the per-task table followed by printSummary()'s figures
     void printMetrics() const;
+    // Averages, throughput, utilisation and latency percentiles only
+    void printSummary() const;
+    // Writes every task of the last run() to `sink` and finishes it; waiting
+    // time leaves out I/O
+    void writeResults(ResultSink& sink) const;
+    
+    // Online use on a single CPU. The first submit() starts a session with
+    // any tasks added so far; later tasks may be submitted at any time at or
+    // after now(), and the clock only moves when advanced. run() ends the
+    // session. Tasks with I/O phases throw std::invalid_argument.
+    void submit(const Task& t);
+    // Simulates up to and including `time`
+    void advanceUntil(SimTime time);
+    // Delivers at most `count` events; returns how many were delivered
+    size_t advanceEvents(size_t count);
+    // Tasks completed since the last call, in completion order
+    std::vector<TaskCompletion> drainCompletions();
+    // Submitted tasks not yet completed
+    size_t pending() const { return online ? online->pending() : 0; }
+    // Summary of every task completed in the session, including ones whose
+    // records have already been drained and dropped
+    const StreamingMetrics& onlineMetrics() const { return online_metrics; }
+    SimTime now() const { return current_time; }
 };
 
+template <class Queue>
+void Scheduler::simulate(Queue& queue) {
+    if (!io.empty()) {
+        simulateIo(queue);
+    } else if (cpu_count > 1) {
+        simulateSmp(queue);
+    } else {
+        engine.recordTimeline(timeline);
+        engine.run(queue);
+        current_time = engine.now();
+        dispatch_count = engine.dispatches();
+        counts = engine.counters();
+    }
+    if (SCHED_STATS) reportCounters();
+}
+
+template <class Queue>
+void TaskScheduler::simulate(Queue& queue) {
+    if (!io.empty()) {
+        simulateIo(queue);
+    } else if (cpu_count > 1) {
+        simulateSmp(queue);
+    } else {
+        engine.recordTimeline(timeline);
+        engine.streamTo(results);
+        if (snapshot_time >= 0) engine.snapshotAt(snapshot_time, snapshot_path);
+        snapshot_time = -1;
+        if (resume_path.empty()) {
+            engine.run(queue);
+        } else {
+            engine.resume(queue, resume_path);
+        }
+        current_time = engine.now();
+        dispatch_count = engine.dispatches();
+        counts = engine.counters();
+    }
+    if (SCHED_STATS) reportCounters();
+}
+
 #endif
\ No newline at end of file
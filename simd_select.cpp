@@ -0,0 +1,210 @@
+#include "simd_select.h"
+#include <climits>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SELECT_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+template <class T>
+T minScalar(const T* v, size_t n) {
+    T best = v[0];
+    for (size_t i = 1; i < n; i++) {
+        if (v[i] < best) best = v[i];
+    }
+    return best;
+}
+
+template <class T>
+size_t findEqualScalar(const T* v, size_t n, size_t from, T value) {
+    for (size_t i = from; i < n; i++) {
+        if (v[i] == value) return i;
+    }
+    return n;
+}
+
+#ifdef SELECT_X86
+__attribute__((target("avx2")))
+int32_t minAvx2(const int32_t* v, size_t n) {
+    size_t i = 0;
+    int32_t best = INT32_MAX;
+    if (n >= 8) {
+        __m256i acc = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(v));
+        for (i = 8; i + 8 <= n; i += 8) {
+            acc = _mm256_min_epi32(acc, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(v + i)));
+        }
+        __m128i m = _mm_min_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+        m = _mm_min_epi32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(1, 0, 3, 2)));
+        m = _mm_min_epi32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(2, 3, 0, 1)));
+        best = _mm_cvtsi128_si32(m);
+    }
+    for (; i < n; i++) {
+        if (v[i] < best) best = v[i];
+    }
+    return best;
+}
+
+__attribute__((target("avx2")))
+size_t findEqualAvx2(const int32_t* v, size_t n, size_t from, int32_t value) {
+    __m256i needle = _mm256_set1_epi32(value);
+    size_t i = from;
+    for (; i + 8 <= n; i += 8) {
+        __m256i eq = _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(v + i)), needle);
+        int mask = _mm256_movemask_ps(_mm256_castsi256_ps(eq));
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    return findEqualScalar(v, n, i, value);
+}
+
+// 64-bit lanes have no min instruction below AVX-512, so compare and blend
+__attribute__((target("avx2")))
+int64_t minAvx2(const int64_t* v, size_t n) {
+    size_t i = 0;
+    int64_t best = INT64_MAX;
+    if (n >= 4) {
+        __m256i acc = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(v));
+        for (i = 4; i + 4 <= n; i += 4) {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(v + i));
+            acc = _mm256_blendv_epi8(acc, x, _mm256_cmpgt_epi64(acc, x));
+        }
+        __m128i lo = _mm256_castsi256_si128(acc);
+        __m128i hi = _mm256_extracti128_si256(acc, 1);
+        __m128i m = _mm_blendv_epi8(lo, hi, _mm_cmpgt_epi64(lo, hi));
+        m = _mm_blendv_epi8(m, _mm_unpackhi_epi64(m, m), _mm_cmpgt_epi64(m, _mm_unpackhi_epi64(m, m)));
+        best = _mm_cvtsi128_si64(m);
+    }
+    for (; i < n; i++) {
+        if (v[i] < best) best = v[i];
+    }
+    return best;
+}
+
+__attribute__((target("avx2")))
+size_t findEqualAvx2(const int64_t* v, size_t n, size_t from, int64_t value) {
+    __m256i needle = _mm256_set1_epi64x(value);
+    size_t i = from;
+    for (; i + 4 <= n; i += 4) {
+        __m256i eq = _mm256_cmpeq_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(v + i)), needle);
+        int mask = _mm256_movemask_pd(_mm256_castsi256_pd(eq));
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    return findEqualScalar(v, n, i, value);
+}
+
+__attribute__((target("sse4.2")))
+int32_t minSse42(const int32_t* v, size_t n) {
+    size_t i = 0;
+    int32_t best = INT32_MAX;
+    if (n >= 4) {
+        __m128i acc = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v));
+        for (i = 4; i + 4 <= n; i += 4) {
+            acc = _mm_min_epi32(acc, _mm_loadu_si128(reinterpret_cast<const __m128i*>(v + i)));
+        }
+        acc = _mm_min_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+        acc = _mm_min_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+        best = _mm_cvtsi128_si32(acc);
+    }
+    for (; i < n; i++) {
+        if (v[i] < best) best = v[i];
+    }
+    return best;
+}
+
+__attribute__((target("sse4.2")))
+size_t findEqualSse42(const int32_t* v, size_t n, size_t from, int32_t value) {
+    __m128i needle = _mm_set1_epi32(value);
+    size_t i = from;
+    for (; i + 4 <= n; i += 4) {
+        __m128i eq = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(v + i)), needle);
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(eq));
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    return findEqualScalar(v, n, i, value);
+}
+
+__attribute__((target("sse4.2")))
+int64_t minSse42(const int64_t* v, size_t n) {
+    size_t i = 0;
+    int64_t best = INT64_MAX;
+    if (n >= 2) {
+        __m128i acc = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v));
+        for (i = 2; i + 2 <= n; i += 2) {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v + i));
+            acc = _mm_blendv_epi8(acc, x, _mm_cmpgt_epi64(acc, x));
+        }
+        __m128i hi = _mm_unpackhi_epi64(acc, acc);
+        acc = _mm_blendv_epi8(acc, hi, _mm_cmpgt_epi64(acc, hi));
+        best = _mm_cvtsi128_si64(acc);
+    }
+    for (; i < n; i++) {
+        if (v[i] < best) best = v[i];
+    }
+    return best;
+}
+
+__attribute__((target("sse4.2")))
+size_t findEqualSse42(const int64_t* v, size_t n, size_t from, int64_t value) {
+    __m128i needle = _mm_set1_epi64x(value);
+    size_t i = from;
+    for (; i + 2 <= n; i += 2) {
+        __m128i eq = _mm_cmpeq_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(v + i)), needle);
+        int mask = _mm_movemask_pd(_mm_castsi128_pd(eq));
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    return findEqualScalar(v, n, i, value);
+}
+#endif
+
+struct Kernels {
+    int32_t (*min32)(const int32_t*, size_t);
+    int64_t (*min64)(const int64_t*, size_t);
+    size_t (*find_equal32)(const int32_t*, size_t, size_t, int32_t);
+    size_t (*find_equal64)(const int64_t*, size_t, size_t, int64_t);
+    const char* isa;
+};
+
+Kernels detect() {
+#ifdef SELECT_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        Kernels k = { minAvx2, minAvx2, findEqualAvx2, findEqualAvx2, "avx2" };
+        return k;
+    }
+    if (__builtin_cpu_supports("sse4.2")) {
+        Kernels k = { minSse42, minSse42, findEqualSse42, findEqualSse42, "sse4.2" };
+        return k;
+    }
+#endif
+    Kernels k = { minScalar<int32_t>, minScalar<int64_t>,
+                  findEqualScalar<int32_t>, findEqualScalar<int64_t>, "scalar" };
+    return k;
+}
+
+const Kernels& kernels() {
+    static const Kernels k = detect();
+    return k;
+}
+
+}
+
+int32_t selectMin(const int32_t* v, size_t n) {
+    return kernels().min32(v, n);
+}
+
+int64_t selectMin(const int64_t* v, size_t n) {
+    return kernels().min64(v, n);
+}
+
+size_t selectFindEqual(const int32_t* v, size_t n, size_t from, int32_t value) {
+    return kernels().find_equal32(v, n, from, value);
+}
+
+size_t selectFindEqual(const int64_t* v, size_t n, size_t from, int64_t value) {
+    return kernels().find_equal64(v, n, from, value);
+}
+
+const char* selectIsa() {
+    return kernels().isa;
+}
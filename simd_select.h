@@ -0,0 +1,22 @@
+#ifndef SIMD_SELECT_H
+#define SIMD_SELECT_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Vectorised kernels for the "eligible and minimal" selection scans. Each
+// call uses the widest instruction set the CPU reports at runtime (AVX2,
+// then SSE4.2), falling back to a scalar loop elsewhere.
+
+// Smallest value in v[0..n); n must be non-zero
+int32_t selectMin(const int32_t* v, size_t n);
+int64_t selectMin(const int64_t* v, size_t n);
+
+// First index i >= from with v[i] == value, or n if there is none
+size_t selectFindEqual(const int32_t* v, size_t n, size_t from, int32_t value);
+size_t selectFindEqual(const int64_t* v, size_t n, size_t from, int64_t value);
+
+// Name of the kernel set picked for this CPU ("avx2", "sse4.2" or "scalar")
+const char* selectIsa();
+
+#endif
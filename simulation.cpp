@@ -0,0 +1,1097 @@
+#include "simulation.h"
+#include <limits>
+#include <stdexcept>
+
+std::vector<int> arrivalOrder(const TaskStore& tasks) {
+    std::vector<int> order;
+    arrivalOrder(tasks, order);
+    return order;
+}
+
+// Ties are broken on index explicitly, so the in-place std::sort gives the
+// stable order without stable_sort's temporary buffer
+void arrivalOrder(const TaskStore& tasks, std::vector<int>& order) {
+    order.resize(tasks.size());
+    for (size_t i = 0; i < order.size(); i++) order[i] = i;
+    std::sort(order.begin(), order.end(),
+              [&tasks](int a, int b) {
+                  SimTime ta = tasks.arrivalTime(a), tb = tasks.arrivalTime(b);
+                  return ta < tb || (ta == tb && a < b);
+              });
+}
+
+// Event queue
+void EventQueue::reset(const TaskStore& tasks, const std::vector<int>* order) {
+    store = &tasks;
+    if (order) {
+        arrivals = order->data();
+    } else {
+        arrivalOrder(tasks, sorted);
+        arrivals = sorted.data();
+    }
+    arrival_count = tasks.size();
+    next_arrival = 0;
+    timers.clear();
+}
+
+bool EventQueue::empty() const {
+    return next_arrival == arrival_count && timers.empty();
+}
+
+SimTime EventQueue::nextTime() const {
+    if (next_arrival == arrival_count) return timers.front().time;
+    SimTime arrival = store->arrivalTime(arrivals[next_arrival]);
+    if (timers.empty()) return arrival;
+    return std::min(arrival, timers.front().time);
+}
+
+Event EventQueue::pop() {
+    if (next_arrival < arrival_count) {
+        int job = arrivals[next_arrival];
+        SimTime arrival = store->arrivalTime(job);
+        if (timers.empty() || arrival <= timers.front().time) {
+            next_arrival++;
+            return Event(arrival, EVENT_ARRIVAL, job);
+        }
+    }
+    std::pop_heap(timers.begin(), timers.end(), Later());
+    Event e = timers.back();
+    timers.pop_back();
+    return e;
+}
+
+void EventQueue::save(SnapshotWriter& out) const {
+    out.put(static_cast<uint64_t>(next_arrival));
+    out.putVector(timers);
+}
+
+void EventQueue::load(SnapshotReader& in) {
+    uint64_t cursor = in.get<uint64_t>();
+    if (cursor > arrival_count) in.fail("arrival cursor past the last task");
+    next_arrival = cursor;
+    in.getVector(timers);
+}
+
+// Ready-queue policies
+void ReadyQueue::save(SnapshotWriter& out) const {
+    (void)out;
+    throw std::logic_error("this ready queue does not support snapshots");
+}
+
+void ReadyQueue::load(SnapshotReader& in) {
+    (void)in;
+    throw std::logic_error("this ready queue does not support snapshots");
+}
+
+void ReadyQueue::queued(std::vector<int>& jobs) const {
+    (void)jobs;
+    throw std::logic_error("this ready queue does not support snapshots");
+}
+
+void JobRing::grow() {
+    std::vector<int> larger(slots.empty() ? 64 : slots.size() * 2);
+    for (size_t i = 0; i < count; i++) {
+        larger[i] = slots[(head + i) & (slots.size() - 1)];
+    }
+    slots.swap(larger);
+    head = 0;
+}
+
+void JobRing::save(SnapshotWriter& out) const {
+    std::vector<int> order(count);
+    for (size_t i = 0; i < count; i++) order[i] = at(i);
+    out.putVector(order);
+}
+
+void JobRing::load(SnapshotReader& in) {
+    size_t n;
+    const int* order = in.getArray<int>(n);
+    clear();
+    for (size_t i = 0; i < n; i++) push(order[i]);
+}
+
+std::unique_ptr<ReadyQueue> FifoQueue::clone() const {
+    return std::unique_ptr<ReadyQueue>(new FifoQueue());
+}
+
+void FifoQueue::reset(const TaskStore& tasks) {
+    (void)tasks;
+    ready.clear();
+}
+
+void FifoQueue::save(SnapshotWriter& out) const {
+    out.section("FIFO");
+    ready.save(out);
+}
+
+void FifoQueue::load(SnapshotReader& in) {
+    in.expect("FIFO");
+    ready.load(in);
+}
+
+RoundRobinQueue::RoundRobinQueue(SimTime q) : quantum(0) {
+    setQuantum(q);
+}
+
+void RoundRobinQueue::setQuantum(SimTime q) {
+    if (q <= 0) {
+        throw std::invalid_argument("RR quantum must be positive");
+    }
+    quantum = q;
+}
+
+std::unique_ptr<ReadyQueue> RoundRobinQueue::clone() const {
+    return std::unique_ptr<ReadyQueue>(new RoundRobinQueue(quantum));
+}
+
+void RoundRobinQueue::reset(const TaskStore& tasks) {
+    (void)tasks;
+    ready.clear();
+}
+
+// The quantum is the resuming queue's own
+void RoundRobinQueue::save(SnapshotWriter& out) const {
+    out.section("RRQU");
+    ready.save(out);
+}
+
+void RoundRobinQueue::load(SnapshotReader& in) {
+    in.expect("RRQU");
+    ready.load(in);
+}
+
+// Multi-level feedback queue
+MlfqConfig MlfqConfig::geometric(int levels, SimTime quantum) {
+    MlfqConfig c;
+    for (int i = 0; i < levels; i++) c.quanta.push_back(quantum << i);
+    c.boost_interval = c.quanta.empty() ? 0 : 8 * c.quanta.back();
+    return c;
+}
+
+MlfqQueue::MlfqQueue(const MlfqConfig& c)
+    : shared(std::make_shared<Shared>()), tasks(nullptr),
+      nonempty(0), count(0), local_epoch(0), dispatched(-1) {
+    configure(c);
+}
+
+void MlfqQueue::configure(const MlfqConfig& c) {
+    if (c.quanta.empty() || c.quanta.size() > (size_t)MAX_LEVELS) {
+        throw std::invalid_argument("MLFQ needs 1 to 64 levels");
+    }
+    for (size_t i = 0; i < c.quanta.size(); i++) {
+        if (c.quanta[i] <= 0) {
+            throw std::invalid_argument("MLFQ quanta must be positive");
+        }
+    }
+    config = c;
+    heads.assign(config.quanta.size(), -1);
+    tails.assign(config.quanta.size(), -1);
+    shared->epoch = 0;
+    shared->next_boost = config.boost_interval;
+}
+
+std::unique_ptr<ReadyQueue> MlfqQueue::clone() const {
+    MlfqQueue* copy = new MlfqQueue(config);
+    copy->shared = shared;
+    return std::unique_ptr<ReadyQueue>(copy);
+}
+
+void MlfqQueue::reset(const TaskStore& t) {
+    tasks = &t;
+    Job fresh = { -1, -1, 0, false, 0, 0 };
+    shared->jobs.assign(t.size(), fresh);
+    shared->epoch = 0;
+    shared->next_boost = config.boost_interval;
+    std::fill(heads.begin(), heads.end(), -1);
+    std::fill(tails.begin(), tails.end(), -1);
+    nonempty = 0;
+    count = 0;
+    local_epoch = 0;
+    dispatched = -1;
+}
+
+// Per-job state, admitting jobs submitted after reset() and dropping levels
+// from before the last boost
+MlfqQueue::Job& MlfqQueue::job(int j) {
+    std::vector<Job>& jobs = shared->jobs;
+    if ((size_t)j >= jobs.size()) {
+        Job fresh = { -1, -1, 0, false, 0, 0 };
+        jobs.resize(tasks->size(), fresh);
+    }
+    Job& s = jobs[j];
+    if (s.level < 0) {
+        int last = config.quanta.size() - 1;
+        s.level = config.priority_entry ? std::max(0, std::min(tasks->priority(j), last)) : 0;
+        s.epoch = shared->epoch;
+    } else if (s.epoch != shared->epoch) {
+        s.level = 0;
+        s.used = 0;
+        s.epoch = shared->epoch;
+    }
+    return s;
+}
+
+int MlfqQueue::levelOf(int j) const {
+    const Job& s = shared->jobs[j];
+    return s.epoch == shared->epoch ? s.level : 0;
+}
+
+void MlfqQueue::append(int level, int j) {
+    shared->jobs[j].next = -1;
+    if (tails[level] < 0) {
+        heads[level] = j;
+    } else {
+        shared->jobs[tails[level]].next = j;
+    }
+    tails[level] = j;
+    nonempty |= uint64_t(1) << level;
+}
+
+// Back from the CPU: charge the time it ran against this level
+void MlfqQueue::charge(Job& s, int j) {
+    s.on_cpu = false;
+    s.used += s.dispatched_remaining - tasks->remainingTime(j);
+    if (s.used >= config.quanta[s.level]) {
+        if (s.level + 1 < (int)config.quanta.size()) s.level++;
+        s.used = 0;
+    }
+}
+
+void MlfqQueue::push(int j) {
+    Job& s = job(j);
+    if (s.on_cpu) charge(s, j);
+    append(s.level, j);
+    count++;
+}
+
+// The allotment counts across bursts, so a job that keeps blocking just
+// short of its quantum is still demoted
+void MlfqQueue::block(int j) {
+    Job& s = job(j);
+    if (s.on_cpu) charge(s, j);
+}
+
+// Splices every lower level onto the top one, keeping FIFO order by level
+void MlfqQueue::boost() {
+    local_epoch = shared->epoch;
+    for (size_t level = 1; level < heads.size(); level++) {
+        if (heads[level] < 0) continue;
+        if (tails[0] < 0) {
+            heads[0] = heads[level];
+        } else {
+            shared->jobs[tails[0]].next = heads[level];
+        }
+        tails[0] = tails[level];
+        heads[level] = tails[level] = -1;
+    }
+    nonempty = count ? 1 : 0;
+}
+
+int MlfqQueue::pop() {
+    if (local_epoch != shared->epoch) boost();
+
+    int level = __builtin_ctzll(nonempty);
+    int j = heads[level];
+    heads[level] = shared->jobs[j].next;
+    if (heads[level] < 0) {
+        tails[level] = -1;
+        nonempty &= ~(uint64_t(1) << level);
+    }
+    count--;
+
+    Job& s = job(j);
+    s.on_cpu = true;
+    s.dispatched_remaining = tasks->remainingTime(j);
+    dispatched = j;
+    return j;
+}
+
+void MlfqQueue::tick(SimTime now) {
+    if (config.boost_interval <= 0 || now < shared->next_boost) return;
+    shared->epoch++;
+    shared->next_boost = (now / config.boost_interval + 1) * config.boost_interval;
+}
+
+SimTime MlfqQueue::slice(int j, SimTime remaining) const {
+    const Job& s = shared->jobs[j];
+    SimTime left = config.quanta[s.level] - s.used;
+    return std::min(left, remaining);
+}
+
+bool MlfqQueue::preempts(int arriving, int running) const {
+    return levelOf(arriving) < levelOf(running);
+}
+
+void MlfqQueue::queued(std::vector<int>& jobs) const {
+    for (size_t level = 0; level < heads.size(); level++) {
+        for (int j = heads[level]; j >= 0; j = shared->jobs[j].next) jobs.push_back(j);
+    }
+}
+
+// Per-job state is kept only for the queued jobs and the one on the CPU:
+// jobs yet to arrive are as reset() leaves them, and finished ones are
+// never read again. Fields go out as columns so padding never reaches the
+// file.
+void MlfqQueue::save(SnapshotWriter& out) const {
+    out.section("MLFQ");
+    out.put(static_cast<uint32_t>(heads.size()));
+    out.put(shared->epoch);
+    out.put(local_epoch);
+    out.put(shared->next_boost);
+
+    std::vector<int> levels;
+    std::vector<int> members;
+    for (size_t level = 0; level < heads.size(); level++) {
+        for (int j = heads[level]; j >= 0; j = shared->jobs[j].next) {
+            levels.push_back(level);
+            members.push_back(j);
+        }
+    }
+    out.putVector(levels);
+    out.putVector(members);
+
+    if (dispatched >= 0 && shared->jobs[dispatched].on_cpu &&
+        tasks->remainingTime(dispatched) > 0) {
+        members.push_back(dispatched);
+    }
+    size_t n = members.size();
+    std::vector<int> level(n);
+    std::vector<unsigned> epoch(n);
+    std::vector<uint8_t> on_cpu(n);
+    std::vector<SimTime> used(n), dispatched_remaining(n);
+    for (size_t i = 0; i < n; i++) {
+        const Job& s = shared->jobs[members[i]];
+        level[i] = s.level;
+        epoch[i] = s.epoch;
+        on_cpu[i] = s.on_cpu;
+        used[i] = s.used;
+        dispatched_remaining[i] = s.dispatched_remaining;
+    }
+    out.putVector(members);
+    out.putVector(level);
+    out.putVector(epoch);
+    out.putVector(on_cpu);
+    out.putVector(used);
+    out.putVector(dispatched_remaining);
+}
+
+void MlfqQueue::load(SnapshotReader& in) {
+    in.expect("MLFQ");
+    if (in.get<uint32_t>() != heads.size()) in.fail("MLFQ snapshot has a different number of levels");
+    shared->epoch = in.get<unsigned>();
+    local_epoch = in.get<unsigned>();
+    shared->next_boost = in.get<SimTime>();
+
+    size_t n;
+    const int* levels = in.getArray<int>(n);
+    const int* members = in.getColumn<int>(n);
+    size_t m;
+    const int* owners = in.getArray<int>(m);
+    const int* level = in.getColumn<int>(m);
+    const unsigned* epoch = in.getColumn<unsigned>(m);
+    const uint8_t* on_cpu = in.getColumn<uint8_t>(m);
+    const SimTime* used = in.getColumn<SimTime>(m);
+    const SimTime* dispatched_remaining = in.getColumn<SimTime>(m);
+
+    for (size_t i = 0; i < m; i++) {
+        if (owners[i] < 0 || (size_t)owners[i] >= shared->jobs.size() ||
+            level[i] < -1 || level[i] >= (int)heads.size()) {
+            in.fail("MLFQ job state out of range");
+        }
+        Job& s = shared->jobs[owners[i]];
+        s.level = level[i];
+        s.epoch = epoch[i];
+        s.on_cpu = on_cpu[i] != 0;
+        s.used = used[i];
+        s.dispatched_remaining = dispatched_remaining[i];
+        if (s.on_cpu) dispatched = owners[i];
+    }
+    for (size_t i = 0; i < n; i++) {
+        if (levels[i] < 0 || levels[i] >= (int)heads.size() ||
+            members[i] < 0 || (size_t)members[i] >= shared->jobs.size()) {
+            in.fail("MLFQ queue entry out of range");
+        }
+        append(levels[i], members[i]);
+        count++;
+    }
+}
+
+// Completely fair queue
+namespace {
+
+// Linux sched_prio_to_weight, nice -20 to 19
+const int NICE_WEIGHTS[40] = {
+    88761, 71755, 56483, 46273, 36291,
+    29154, 23254, 18705, 14949, 11916,
+     9548,  7620,  6100,  4904,  3906,
+     3121,  2501,  1991,  1586,  1277,
+     1024,   820,   655,   526,   423,
+      335,   272,   215,   172,   137,
+      110,    87,    70,    56,    45,
+       36,    29,    23,    18,    15,
+};
+
+const double NICE_0_WEIGHT = 1024;
+
+}
+
+FairQueue::FairQueue(const FairConfig& c)
+    : config(c), jobs(std::make_shared<std::vector<Job> >()), tasks(nullptr),
+      min_vruntime(0), queued_weight(0), running_weight(0),
+      last_scan(0), dispatched(-1) {}
+
+double FairQueue::weight(int priority) {
+    return NICE_WEIGHTS[std::max(-20, std::min(priority, 19)) + 20];
+}
+
+std::unique_ptr<ReadyQueue> FairQueue::clone() const {
+    FairQueue* copy = new FairQueue(config);
+    copy->jobs = jobs;
+    return std::unique_ptr<ReadyQueue>(copy);
+}
+
+void FairQueue::reset(const TaskStore& t) {
+    tasks = &t;
+    Job fresh = { 0, false, false, 0 };
+    jobs->assign(t.size(), fresh);
+    heap.clear();
+    min_vruntime = 0;
+    queued_weight = 0;
+    running_weight = 0;
+    dispatched = -1;
+}
+
+FairQueue::Job& FairQueue::job(int j) {
+    if ((size_t)j >= jobs->size()) {
+        Job fresh = { 0, false, false, 0 };
+        jobs->resize(tasks->size(), fresh);
+    }
+    return (*jobs)[j];
+}
+
+// Virtual runtime including the time run since the last dispatch
+double FairQueue::currentVruntime(int j) const {
+    const Job& s = (*jobs)[j];
+    if (!s.on_cpu) return s.vruntime;
+    SimTime ran = s.dispatched_remaining - tasks->remainingTime(j);
+    return s.vruntime + ran * NICE_0_WEIGHT / weight(tasks->priority(j));
+}
+
+void FairQueue::push(int j) {
+    Job& s = job(j);
+    if (s.on_cpu) {
+        s.vruntime = currentVruntime(j);
+        s.on_cpu = false;
+        running_weight = 0;
+    } else if (!s.admitted) {
+        s.vruntime = min_vruntime;
+    } else {
+        // Waking up: a long sleep earns half a latency of credit, no more
+        s.vruntime = std::max(s.vruntime, min_vruntime - config.target_latency / 2.0);
+    }
+    s.admitted = true;
+    heap.push_back(Entry(s.vruntime, j));
+    std::push_heap(heap.begin(), heap.end(), std::greater<Entry>());
+    queued_weight += weight(tasks->priority(j));
+}
+
+int FairQueue::pop() {
+    if (SCHED_STATS) last_scan = 2 * (64 - __builtin_clzll(heap.size()));
+    std::pop_heap(heap.begin(), heap.end(), std::greater<Entry>());
+    int j = heap.back().second;
+    heap.pop_back();
+
+    Job& s = (*jobs)[j];
+    double w = weight(tasks->priority(j));
+    queued_weight = heap.empty() ? 0 : queued_weight - w;
+    running_weight = w;
+    min_vruntime = std::max(min_vruntime, s.vruntime);
+    s.on_cpu = true;
+    s.dispatched_remaining = tasks->remainingTime(j);
+    dispatched = j;
+    return j;
+}
+
+SimTime FairQueue::slice(int j, SimTime remaining) const {
+    (void)j;
+    double total = queued_weight + running_weight;
+    SimTime share = static_cast<SimTime>(config.target_latency * running_weight / total);
+    SimTime floor = std::max<SimTime>(config.min_granularity, 1);
+    return std::min(std::max(share, floor), remaining);
+}
+
+bool FairQueue::preempts(int arriving, int running) const {
+    return currentVruntime(arriving) + config.min_granularity < currentVruntime(running);
+}
+
+void FairQueue::block(int j) {
+    Job& s = job(j);
+    if (!s.on_cpu) return;
+    s.vruntime = currentVruntime(j);
+    s.on_cpu = false;
+    running_weight = 0;
+}
+
+void FairQueue::queued(std::vector<int>& jobs) const {
+    for (size_t i = 0; i < heap.size(); i++) jobs.push_back(heap[i].second);
+}
+
+// The heap goes out as columns in heap order, then per-job state for the
+// queued jobs and the one on the CPU, like MlfqQueue
+void FairQueue::save(SnapshotWriter& out) const {
+    out.section("CFSQ");
+    out.put(min_vruntime);
+    out.put(queued_weight);
+    out.put(running_weight);
+
+    std::vector<double> keys(heap.size());
+    std::vector<int> members(heap.size());
+    for (size_t i = 0; i < heap.size(); i++) {
+        keys[i] = heap[i].first;
+        members[i] = heap[i].second;
+    }
+    out.putVector(keys);
+    out.putVector(members);
+
+    if (dispatched >= 0 && (*jobs)[dispatched].on_cpu && tasks->remainingTime(dispatched) > 0) {
+        members.push_back(dispatched);
+    }
+    size_t n = members.size();
+    std::vector<double> vruntime(n);
+    std::vector<uint8_t> admitted(n), on_cpu(n);
+    std::vector<SimTime> dispatched_remaining(n);
+    for (size_t i = 0; i < n; i++) {
+        const Job& s = (*jobs)[members[i]];
+        vruntime[i] = s.vruntime;
+        admitted[i] = s.admitted;
+        on_cpu[i] = s.on_cpu;
+        dispatched_remaining[i] = s.dispatched_remaining;
+    }
+    out.putVector(members);
+    out.putVector(vruntime);
+    out.putVector(admitted);
+    out.putVector(on_cpu);
+    out.putVector(dispatched_remaining);
+}
+
+void FairQueue::load(SnapshotReader& in) {
+    in.expect("CFSQ");
+    min_vruntime = in.get<double>();
+    queued_weight = in.get<double>();
+    running_weight = in.get<double>();
+
+    size_t n;
+    const double* keys = in.getArray<double>(n);
+    const int* members = in.getColumn<int>(n);
+    size_t m;
+    const int* owners = in.getArray<int>(m);
+    const double* vruntime = in.getColumn<double>(m);
+    const uint8_t* admitted = in.getColumn<uint8_t>(m);
+    const uint8_t* on_cpu = in.getColumn<uint8_t>(m);
+    const SimTime* dispatched_remaining = in.getColumn<SimTime>(m);
+
+    for (size_t i = 0; i < m; i++) {
+        if (owners[i] < 0 || (size_t)owners[i] >= jobs->size()) in.fail("CFS job out of range");
+        Job& s = (*jobs)[owners[i]];
+        s.vruntime = vruntime[i];
+        s.admitted = admitted[i] != 0;
+        s.on_cpu = on_cpu[i] != 0;
+        s.dispatched_remaining = dispatched_remaining[i];
+        if (s.on_cpu) dispatched = owners[i];
+    }
+    heap.clear();
+    for (size_t i = 0; i < n; i++) {
+        if (members[i] < 0 || (size_t)members[i] >= jobs->size()) in.fail("CFS job out of range");
+        heap.push_back(Entry(keys[i], members[i]));
+    }
+}
+
+std::unique_ptr<ReadyQueue> makeReadyQueue(const std::string& algorithm, SimTime quantum) {
+    std::unique_ptr<ReadyQueue> queue;
+    if (algorithm == "FCFS") {
+        queue.reset(new FifoQueue());
+    } else if (algorithm == "SJF") {
+        queue.reset(new KeyedQueue<BurstKey>());
+    } else if (algorithm == "SRTF") {
+        queue.reset(new KeyedQueue<RemainingKey>());
+    } else if (algorithm == "RR") {
+        queue.reset(new RoundRobinQueue(quantum));
+    } else if (algorithm == "Priority") {
+        queue.reset(new KeyedQueue<PriorityKey>());
+    } else if (algorithm == "MLFQ") {
+        queue.reset(new MlfqQueue(MlfqConfig::geometric(3, quantum)));
+    } else if (algorithm == "CFS") {
+        queue.reset(new FairQueue(FairConfig(6 * quantum, quantum)));
+    }
+    return queue;
+}
+
+// Simulation core
+void EventSimulator::begin(ReadyQueue& queue) {
+    tasks.resetOutputs();
+    events.reset(tasks, arrival_order);
+    queue.reset(tasks);
+    online = nullptr;
+    current_time = 0;
+    running = -1;
+    dispatch_tag = 0;
+    submit_seq = 0;
+    dispatch_count = 0;
+    completed = 0;
+    rotation_left = 0;
+    stats.clear();
+    last_job = -1;
+    finished.clear();
+    next_checkpoint = checkpoint_interval;
+    converged_at = nullptr;
+    planStops();
+}
+
+void EventSimulator::planStops() {
+    next_stop = snapshot_time;
+    if (checkpoint_interval > 0 && (next_stop < 0 || next_checkpoint < next_stop)) {
+        next_stop = next_checkpoint;
+    }
+}
+
+// Sections in order: engine registers, events, task columns, ready queue,
+// metrics
+void EventSimulator::save(const ReadyQueue& queue) {
+    SnapshotWriter out(snapshot_path);
+    out.writeHeader(tasks, snapshot_time);
+    snapshot_time = -1;
+    planStops();
+
+    out.section("ENGN");
+    out.put(current_time);
+    out.put(run_since);
+    out.put(static_cast<int32_t>(running));
+    out.put(static_cast<int32_t>(last_job));
+    out.put(static_cast<uint32_t>(dispatch_tag));
+    out.put(static_cast<uint32_t>(submit_seq));
+    out.put(static_cast<uint64_t>(dispatch_count));
+    out.put(static_cast<uint64_t>(completed));
+    out.put(static_cast<uint64_t>(rotation_left));
+    out.put(stats);
+
+    out.section("EVNT");
+    events.save(out);
+
+    out.section("TASK");
+    out.putArray(tasks.remainingData(), tasks.size());
+    out.putArray(tasks.startData(), tasks.size());
+    out.putArray(tasks.completionData(), tasks.size());
+
+    out.section("QUEU");
+    queue.save(out);
+
+    out.section("MTRC");
+    out.put(static_cast<uint8_t>(sink != nullptr));
+    if (sink) sink->save(out);
+
+    out.section("END!");
+    out.finish();
+}
+
+void EventSimulator::restore(ReadyQueue& queue, const std::string& path) {
+    SnapshotReader in(path);
+    in.checkWorkload(tasks);
+    size_t n = tasks.size();
+
+    in.expect("ENGN");
+    current_time = in.get<SimTime>();
+    run_since = in.get<SimTime>();
+    running = in.get<int32_t>();
+    last_job = in.get<int32_t>();
+    dispatch_tag = in.get<uint32_t>();
+    submit_seq = in.get<uint32_t>();
+    dispatch_count = in.get<uint64_t>();
+    completed = in.get<uint64_t>();
+    rotation_left = in.get<uint64_t>();
+    stats = in.get<SchedulerCounters>();
+    if (running >= (int)n || completed > n) in.fail("engine state out of range");
+
+    in.expect("EVNT");
+    events.load(in);
+
+    in.expect("TASK");
+    size_t columns[3];
+    const SimTime* remaining = in.getArray<SimTime>(columns[0]);
+    const SimTime* starts = in.getArray<SimTime>(columns[1]);
+    const SimTime* completions = in.getArray<SimTime>(columns[2]);
+    for (int c = 0; c < 3; c++) {
+        if (columns[c] != n) in.fail("task columns have the wrong length");
+    }
+    tasks.restoreOutputs(remaining, starts, completions);
+
+    in.expect("QUEU");
+    queue.load(in);
+
+    in.expect("MTRC");
+    bool saved = in.get<uint8_t>() != 0;
+    if (saved != (sink != nullptr)) {
+        in.fail(saved ? "snapshot has metrics but none are recorded"
+                      : "metrics are recorded but the snapshot has none");
+    }
+    if (sink) sink->load(in);
+    in.expect("END!");
+}
+
+// A running job is charged up to `at`, as an arrival then would, so runs
+// that reached the same state by different event times compare equal
+void EventSimulator::capture(const ReadyQueue& queue, SimTime at, Checkpoint& c) {
+    c.time = at;
+    c.running = running;
+    c.slice_end = running >= 0 ? slice_end : 0;
+    c.next_arrival = events.arrivalsDelivered();
+    c.completed = completed;
+    c.dispatches = dispatch_count;
+
+    c.active.clear();
+    queue.queued(c.active);
+    if (running >= 0) c.active.push_back(running);
+    std::sort(c.active.begin(), c.active.end());
+    c.remaining.resize(c.active.size());
+    c.starts.resize(c.active.size());
+    for (size_t i = 0; i < c.active.size(); i++) {
+        int job = c.active[i];
+        c.remaining[i] = tasks.remainingTime(job);
+        if (job == running) c.remaining[i] -= at - run_since;
+        c.starts[i] = tasks.startTime(job);
+    }
+    c.queue.clear();
+    SnapshotWriter out(c.queue);
+    queue.save(out);
+}
+
+bool sameState(const Checkpoint& a, const Checkpoint& b) {
+    return a.time == b.time && a.running == b.running &&
+           a.slice_end == b.slice_end && a.next_arrival == b.next_arrival &&
+           a.completed == b.completed && a.active == b.active &&
+           a.remaining == b.remaining && a.starts == b.starts && a.queue == b.queue;
+}
+
+// The fields that are cheap to compare, before copying out the whole state
+bool EventSimulator::likeBaseline(const Checkpoint& base, const ReadyQueue& queue) const {
+    size_t active = queue.size() + (running >= 0 ? 1 : 0);
+    if (base.running != running || base.completed != completed ||
+        base.next_arrival != events.arrivalsDelivered() || base.active.size() != active) {
+        return false;
+    }
+    if (running < 0) return true;
+    std::vector<int>::const_iterator it =
+        std::lower_bound(base.active.begin(), base.active.end(), running);
+    SimTime left = tasks.remainingTime(running) - (base.time - run_since);
+    return base.slice_end == slice_end && base.remaining[it - base.active.begin()] == left;
+}
+
+// Called once every event up to next_stop is delivered and the CPU is
+// settled: busy, or idle with nothing queued. True ends the run.
+bool EventSimulator::pause(const ReadyQueue& queue) {
+    SimTime at = next_stop;
+    if (snapshot_time >= 0 && snapshot_time <= at) save(queue);
+    if (checkpoint_interval <= 0 || next_checkpoint > at) return false;
+
+    if (checkpoint_log) {
+        checkpoint_log->push_back(Checkpoint());
+        capture(queue, at, checkpoint_log->back());
+    }
+    if (baseline && at >= converge_from) {
+        std::vector<Checkpoint>::const_iterator base = std::lower_bound(
+            baseline->begin(), baseline->end(), at,
+            [](const Checkpoint& c, SimTime t) { return c.time < t; });
+        // Every edited task has arrived by now, so one still unfinished is
+        // queued or running
+        bool settled = true;
+        for (size_t i = 0; changed && i < changed->size() && settled; i++) {
+            settled = tasks.remainingTime((*changed)[i]) == 0;
+        }
+        if (settled && base != baseline->end() && base->time == at && likeBaseline(*base, queue)) {
+            const Checkpoint& mine = checkpoint_log ? checkpoint_log->back() : probe;
+            if (!checkpoint_log) capture(queue, at, probe);
+            if (sameState(mine, *base)) {
+                converged_at = &*base;
+                return true;
+            }
+        }
+    }
+
+    // Labels with no event since the last one would repeat its state
+    next_checkpoint = at + checkpoint_interval;
+    if (!events.empty() && events.nextTime() > next_checkpoint) {
+        SimTime next = events.nextTime();
+        next_checkpoint = (next + checkpoint_interval - 1) / checkpoint_interval * checkpoint_interval;
+    }
+    planStops();
+    return false;
+}
+
+void EventSimulator::restore(ReadyQueue& queue, const Checkpoint& from, const TaskStore& prior) {
+    size_t n = tasks.size();
+    if (prior.size() != n) {
+        throw std::invalid_argument("checkpoint is from a run over other tasks");
+    }
+    current_time = from.time;
+    running = from.running;
+    run_since = from.time;
+    dispatch_count = from.dispatches;
+    completed = from.completed;
+    events.skipArrivals(from.next_arrival);
+    if (running >= 0) {
+        slice_end = from.slice_end;
+        events.schedule(Event(slice_end, EVENT_SLICE_END, running, ++dispatch_tag));
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        if (prior.completionTime(i) <= from.time) {
+            tasks.remainingTime(i) = 0;
+            tasks.startTime(i) = prior.startTime(i);
+            tasks.completionTime(i) = prior.completionTime(i);
+        }
+    }
+    for (size_t i = 0; i < from.active.size(); i++) {
+        tasks.remainingTime(from.active[i]) = from.remaining[i];
+        tasks.startTime(from.active[i]) = from.starts[i];
+    }
+    SnapshotReader in(from.queue, "checkpoint");
+    queue.load(in);
+
+    next_checkpoint = from.time + checkpoint_interval;
+    planStops();
+}
+
+void EventSimulator::start(ReadyQueue& queue) {
+    begin(queue);
+    online = &queue;
+}
+
+int EventSimulator::submit(int id, SimTime arrival, SimTime burst, int priority) {
+    if (!online) {
+        throw std::logic_error("submit() outside an online session");
+    }
+    if (arrival < current_time) {
+        throw std::invalid_argument("task " + std::to_string(id) +
+                                    " arrives before the current time");
+    }
+    tasks.add(id, arrival, burst, priority);
+    int job = tasks.size() - 1;
+    events.schedule(Event(arrival, EVENT_ARRIVAL, job, submit_seq++));
+    return job;
+}
+
+// Same order as run(): the CPU is only handed out once the current instant
+// has no events left
+size_t EventSimulator::advance(SimTime until, size_t max_events) {
+    size_t delivered = 0;
+    for (;;) {
+        if (running < 0 && !online->empty() &&
+            (events.empty() || events.nextTime() > current_time)) {
+            dispatch(*online);
+        }
+        if (events.empty() || events.nextTime() > until || delivered == max_events) {
+            return delivered;
+        }
+        Event e = events.pop();
+        current_time = e.time;
+        deliver(e, *online);
+        delivered++;
+    }
+}
+
+size_t EventSimulator::advanceUntil(SimTime time) {
+    if (!online) return 0;
+    size_t delivered = advance(time, std::numeric_limits<size_t>::max());
+    current_time = std::max(current_time, time);
+    return delivered;
+}
+
+size_t EventSimulator::advanceEvents(size_t count) {
+    if (!online) return 0;
+    return advance(std::numeric_limits<SimTime>::max(), count);
+}
+
+void EventSimulator::drainCompletions(std::vector<int>& jobs) {
+    jobs.insert(jobs.end(), finished.begin(), finished.end());
+    finished.clear();
+}
+
+// With nothing arriving, RR serves its queue in a fixed rotation: each round
+// every queued job runs min(remaining, q) in queue order and the survivors
+// keep their places. So the end of round k is
+//     T(k) = now + sum over jobs of min(remaining, k*q)
+// and a job needing c = ceil(remaining / q) rounds completes at
+//     T(c-1) + q * (earlier jobs needing more than c rounds)
+//            + final slices of earlier jobs needing exactly c, and its own.
+// The largest K with T(K) before the next event is found by binary search
+// on the sorted remaining times, and those K rounds are applied at once.
+// Attempts are spaced one rotation apart, so failed ones cost O(1) per
+// dispatch.
+void EventSimulator::skipRounds(RoundRobinQueue& queue) {
+    if (rotation_left > 0) {
+        rotation_left--;
+        return;
+    }
+    JobRing& ring = queue.jobs();
+    size_t m = ring.size();
+    rotation_left = m - 1;
+    if (SCHED_TIMELINE && timeline) return;
+
+    SimTime q = queue.quantumLength();
+    SimTime horizon = events.empty() ? std::numeric_limits<SimTime>::max() : events.nextTime();
+    // Rounds stop at a pending snapshot or checkpoint so it sees the state
+    // at its time
+    if (next_stop >= 0) horizon = std::min(horizon, next_stop + 1);
+    // Every slice of a job with time left takes at least one time unit; an
+    // empty one only makes this bound looser
+    if (horizon - current_time <= static_cast<SimTime>(m)) return;
+    SimTime first_round = 0;
+    for (size_t i = 0; i < m; i++) {
+        first_round += std::min(tasks.remainingTime(ring.at(i)), q);
+    }
+    if (first_round >= horizon - current_time) return;
+
+    std::vector<SimTime>& sorted = scratch.sorted;
+    std::vector<SimTime>& prefix = scratch.prefix;
+    sorted.resize(m);
+    for (size_t i = 0; i < m; i++) sorted[i] = tasks.remainingTime(ring.at(i));
+    std::sort(sorted.begin(), sorted.end());
+    prefix.resize(m + 1);
+    prefix[0] = 0;
+    for (size_t i = 0; i < m; i++) prefix[i + 1] = prefix[i] + sorted[i];
+    SimTime start = current_time;
+    auto roundEnd = [&](SimTime k) {
+        size_t done = std::upper_bound(sorted.begin(), sorted.end(), k * q) - sorted.begin();
+        return start + prefix[done] + k * q * static_cast<SimTime>(m - done);
+    };
+
+    // T(1) is known to fit; find the last round that still does
+    SimTime lo = 1, hi = (sorted.back() + q - 1) / q;
+    while (lo < hi) {
+        SimTime mid = lo + (hi - lo + 1) / 2;
+        if (roundEnd(mid) < horizon) lo = mid;
+        else hi = mid - 1;
+    }
+    SimTime rounds = lo;
+
+    // First dispatches happen in round one, in queue order
+    size_t dispatched_before = dispatch_count;
+    SimTime offset = start;
+    std::vector<SimTime>& needed = scratch.rounds;
+    needed.resize(m);
+    for (size_t i = 0; i < m; i++) {
+        int job = ring.at(i);
+        SimTime remaining = tasks.remainingTime(job);
+        if (tasks.startTime(job) < 0) tasks.startTime(job) = offset;
+        offset += std::min(remaining, q);
+        // A job with nothing left still takes one (empty) slice
+        needed[i] = std::max<SimTime>(1, (remaining + q - 1) / q);
+        dispatch_count += std::min(needed[i], rounds);
+    }
+
+    // Completions, taking groups needing the same number of rounds from the
+    // most rounds down; a Fenwick tree over queue positions counts the
+    // earlier jobs that need more
+    std::vector<int>& order = scratch.order;
+    std::vector<int>& tree = scratch.tree;
+    order.resize(m);
+    for (size_t i = 0; i < m; i++) order[i] = i;
+    std::sort(order.begin(), order.end(), [&needed](int a, int b) {
+        return needed[a] > needed[b] || (needed[a] == needed[b] && a < b);
+    });
+    tree.assign(m + 1, 0);
+    std::vector<std::pair<SimTime, int> >& finishing = scratch.finishing;
+    finishing.clear();
+    for (size_t g = 0; g < m;) {
+        SimTime c = needed[order[g]];
+        size_t h = g;
+        while (h < m && needed[order[h]] == c) h++;
+        if (c <= rounds) {
+            SimTime round_start = roundEnd(c - 1);
+            SimTime finals = 0;
+            for (size_t x = g; x < h; x++) {
+                int pos = order[x];
+                int job = ring.at(pos);
+                finals += tasks.remainingTime(job) - (c - 1) * q;
+                SimTime longer = 0;
+                for (int i = pos; i > 0; i -= i & -i) longer += tree[i];
+                finishing.push_back(std::make_pair(round_start + q * longer + finals, job));
+            }
+        }
+        for (size_t x = g; x < h; x++) {
+            for (size_t i = order[x] + 1; i <= m; i += i & -i) tree[i]++;
+        }
+        g = h;
+    }
+    // Retired in completion order, as the per-slice loop would
+    std::sort(finishing.begin(), finishing.end());
+    for (size_t i = 0; i < finishing.size(); i++) {
+        retire(finishing[i].second, finishing[i].first);
+    }
+
+    if (SCHED_STATS) countSkipped(ring, rounds, dispatch_count - dispatched_before);
+
+    std::vector<int>& survivors = scratch.survivors;
+    survivors.clear();
+    for (size_t i = 0; i < m; i++) {
+        if (needed[i] > rounds) {
+            int job = ring.at(i);
+            tasks.remainingTime(job) -= rounds * q;
+            survivors.push_back(job);
+        }
+    }
+    ring.clear();
+    for (size_t i = 0; i < survivors.size(); i++) ring.push(survivors[i]);
+    current_time = roundEnd(rounds);
+    rotation_left = survivors.size();
+}
+
+// Counters for `rounds` rounds about to be skipped over the queue in `ring`,
+// with scratch.rounds holding the rounds each job needs. Within a round every
+// slice runs a different job, so only the boundary into a round where one
+// job is left (or into the first round, if that job ran last) can continue
+// the same job.
+void EventSimulator::countSkipped(const JobRing& ring, SimTime rounds, uint64_t slices) {
+    const std::vector<SimTime>& needed = scratch.rounds;
+    size_t m = ring.size();
+    size_t longest = 0;
+    SimTime second = 0;
+    for (size_t i = 1; i < m; i++) {
+        if (needed[i] > needed[longest]) {
+            second = needed[longest];
+            longest = i;
+        } else {
+            second = std::max(second, needed[i]);
+        }
+    }
+
+    uint64_t repeats = ring.at(0) == last_job ? 1 : 0;
+    SimTime alone = second + 1;   // first round with only `longest` left
+    if (rounds >= alone) {
+        repeats += rounds - alone;
+        if (alone > 1) {
+            // Repeats into that round if it was also last in the one before
+            bool later = false;
+            for (size_t i = longest + 1; i < m && !later; i++) later = needed[i] >= second;
+            if (!later) repeats++;
+        }
+    }
+
+    stats.dispatches += slices;
+    stats.context_switches += slices - repeats;
+    stats.fast_forwards++;
+    stats.rounds_skipped += rounds;
+    for (size_t i = m; i-- > 0;) {
+        if (needed[i] >= rounds) {
+            last_job = ring.at(i);
+            break;
+        }
+    }
+}
+
+void EventSimulator::account() {
+    if (SCHED_TIMELINE && timeline) {
+        timeline->record(tasks.taskId(running), 0, run_since, current_time);
+    }
+    tasks.remainingTime(running) -= current_time - run_since;
+    run_since = current_time;
+}
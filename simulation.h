@@ -0,0 +1,912 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <vector>
+#include <tuple>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <algorithm>
+#include <functional>
+#include "task_store.h"
+#include "metrics.h"
+#include "timeline.h"
+#include "results.h"
+#include "counters.h"
+#include "snapshot.h"
+#include "simd_select.h"
+
+enum EventType {
+    EVENT_ARRIVAL,
+    EVENT_SLICE_END,
+    EVENT_IO_DONE       // a device finished a job's I/O (see io_sim.h)
+};
+
+struct Event {
+    SimTime time;
+    EventType type;
+    int job;
+    unsigned tag;
+    int cpu;
+
+    Event(SimTime t, EventType ty, int j, unsigned tg = 0, int c = 0)
+        : time(t), type(ty), job(j), tag(tg), cpu(c) {}
+};
+
+// Pending events: arrivals come from an arrival-sorted cursor, everything
+// else from a timer heap. At equal times arrivals are delivered first, then
+// I/O completions, so a job coming off the CPU is requeued behind work that
+// became ready at that instant.
+class EventQueue {
+private:
+    // Submitted arrivals also go through the heap, ahead of slice ends at
+    // the same instant and in submission order (their tag)
+    struct Later {
+        static int rank(EventType type) { return type == EVENT_IO_DONE ? 1 : 2 * type; }
+        bool operator()(const Event& a, const Event& b) const {
+            if (a.time != b.time) return a.time > b.time;
+            if (a.type != b.type) return rank(a.type) > rank(b.type);
+            return a.tag > b.tag;
+        }
+    };
+
+    // Both buffers keep their capacity across reset(), so repeated runs
+    // do not allocate
+    std::vector<int> sorted;
+    const int* arrivals;
+    size_t arrival_count;
+    size_t next_arrival;
+    const TaskStore* store;
+    std::vector<Event> timers;   // binary heap ordered by Later
+
+public:
+    EventQueue()
+        : arrivals(nullptr), arrival_count(0), next_arrival(0), store(nullptr) {}
+
+    // `order` is a precomputed arrivalOrder() of the tasks; without one the
+    // queue sorts its own copy
+    void reset(const TaskStore& tasks, const std::vector<int>* order = nullptr);
+    void schedule(const Event& e) {
+        timers.push_back(e);
+        std::push_heap(timers.begin(), timers.end(), Later());
+    }
+    bool empty() const;
+    SimTime nextTime() const;
+    Event pop();
+
+    // The arrival cursor and pending timers; load() follows a reset() on
+    // the same tasks
+    void save(SnapshotWriter& out) const;
+    void load(SnapshotReader& in);
+    // Arrivals delivered so far
+    size_t arrivalsDelivered() const { return next_arrival; }
+    // Marks the first `count` arrivals delivered, after a reset()
+    void skipArrivals(size_t count) { next_arrival = std::min(count, arrival_count); }
+};
+
+// Task indices sorted by arrival time, insertion order on ties
+std::vector<int> arrivalOrder(const TaskStore& tasks);
+// Same, into `order`, reusing its storage
+void arrivalOrder(const TaskStore& tasks, std::vector<int>& order);
+
+// Ready-queue policy plugged into the simulation core
+class ReadyQueue {
+public:
+    virtual ~ReadyQueue() = default;
+
+    // An empty queue with the same policy, e.g. one per simulated CPU
+    virtual std::unique_ptr<ReadyQueue> clone() const = 0;
+
+    // Called before each run with the tasks whose indices will be queued
+    virtual void reset(const TaskStore& tasks) = 0;
+    virtual void push(int job) = 0;
+    virtual int pop() = 0;
+    virtual bool empty() const = 0;
+    virtual size_t size() const = 0;
+
+    // Called with the current time before each dispatch, for policies
+    // whose ordering changes with time
+    virtual void tick(SimTime now) { (void)now; }
+
+    // Longest time a dispatched job may run before it is requeued
+    virtual SimTime slice(int job, SimTime remaining) const {
+        (void)job;
+        return remaining;
+    }
+
+    // Whether a newly admitted job takes the CPU from the running one
+    virtual bool preempts(int arriving, int running) const {
+        (void)arriving;
+        (void)running;
+        return false;
+    }
+
+    // Called when the job last popped leaves the CPU to wait, e.g. for I/O,
+    // before its next CPU burst is set; it is pushed again once ready
+    virtual void block(int job) { (void)job; }
+
+    // Entries the last pop() examined; kept up to date only in SCHED_STATS
+    // builds
+    virtual size_t scanned() const { return 1; }
+
+    // Checkpoint support (see snapshot.h): save() writes the queued jobs
+    // and per-job policy state, and load() restores them into a queue
+    // reset() on the same tasks. Settings such as quanta are not saved, so
+    // a run may resume under new ones. Both throw std::logic_error for a
+    // policy without snapshots, and load() throws std::runtime_error for a
+    // snapshot of another policy.
+    virtual void save(SnapshotWriter& out) const;
+    virtual void load(SnapshotReader& in);
+    // Appends the queued jobs, in any order; throws std::logic_error like
+    // save()
+    virtual void queued(std::vector<int>& jobs) const;
+};
+
+// Concrete policies are final, so a simulation loop instantiated on one of
+// them (see EventSimulator::run and visitReadyQueue) calls its queue
+// operations directly and the compiler can inline them.
+
+// FIFO of job indices in a power-of-two ring that only grows, so a queue
+// reused across runs stops allocating once it has seen its peak size
+class JobRing {
+private:
+    std::vector<int> slots;
+    size_t head;
+    size_t count;
+
+    void grow();
+
+public:
+    JobRing() : head(0), count(0) {}
+
+    void clear() { head = count = 0; }
+    void push(int job) {
+        if (count == slots.size()) grow();
+        slots[(head + count) & (slots.size() - 1)] = job;
+        count++;
+    }
+    int pop() {
+        int job = slots[head];
+        head = (head + 1) & (slots.size() - 1);
+        count--;
+        return job;
+    }
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+    // i-th job from the front
+    int at(size_t i) const { return slots[(head + i) & (slots.size() - 1)]; }
+
+    // The jobs front to back; load() replaces the contents
+    void save(SnapshotWriter& out) const;
+    void load(SnapshotReader& in);
+    void append(std::vector<int>& jobs) const {
+        for (size_t i = 0; i < count; i++) jobs.push_back(at(i));
+    }
+};
+
+// FCFS: run in admission order to completion
+class FifoQueue final : public ReadyQueue {
+private:
+    JobRing ready;
+
+public:
+    std::unique_ptr<ReadyQueue> clone() const override;
+    void reset(const TaskStore& tasks) override;
+    void push(int job) override { ready.push(job); }
+    int pop() override { return ready.pop(); }
+    bool empty() const override { return ready.empty(); }
+    size_t size() const override { return ready.size(); }
+    void save(SnapshotWriter& out) const override;
+    void load(SnapshotReader& in) override;
+    void queued(std::vector<int>& jobs) const override { ready.append(jobs); }
+};
+
+// Round Robin: FIFO order, at most one quantum per dispatch
+class RoundRobinQueue final : public ReadyQueue {
+private:
+    JobRing ready;
+    SimTime quantum;
+
+public:
+    // Both throw std::invalid_argument for a non-positive quantum
+    explicit RoundRobinQueue(SimTime q);
+    void setQuantum(SimTime q);
+    SimTime quantumLength() const { return quantum; }
+    // Queued jobs in dispatch order, for EventSimulator's round fast-forward
+    JobRing& jobs() { return ready; }
+
+    std::unique_ptr<ReadyQueue> clone() const override;
+    void reset(const TaskStore& tasks) override;
+    void push(int job) override { ready.push(job); }
+    int pop() override { return ready.pop(); }
+    bool empty() const override { return ready.empty(); }
+    size_t size() const override { return ready.size(); }
+    SimTime slice(int job, SimTime remaining) const override {
+        (void)job;
+        return remaining < quantum ? remaining : quantum;
+    }
+    void save(SnapshotWriter& out) const override;
+    void load(SnapshotReader& in) override;
+    void queued(std::vector<int>& jobs) const override { ready.append(jobs); }
+};
+
+// Ordering keys for KeyedQueue: (primary key, tie-breaks..., index)
+typedef std::tuple<SimTime, SimTime, int, int> QueueEntry;
+
+// SJF: burst time, then arrival time, id and index
+struct BurstKey {
+    static const char* name() { return "SJF"; }
+    static const bool preemptive = false;
+    static QueueEntry entry(const TaskStore& t, int job) {
+        return QueueEntry(t.burstTime(job), t.arrivalTime(job), t.taskId(job), job);
+    }
+};
+
+// Priority: lower value first, then arrival time, id and index
+struct PriorityKey {
+    static const char* name() { return "Priority"; }
+    static const bool preemptive = false;
+    static QueueEntry entry(const TaskStore& t, int job) {
+        return QueueEntry(t.priority(job), t.arrivalTime(job), t.taskId(job), job);
+    }
+};
+
+// SRTF: remaining time, ties on index only like the original per-tick scan
+struct RemainingKey {
+    static const char* name() { return "SRTF"; }
+    static const bool preemptive = true;
+    static QueueEntry entry(const TaskStore& t, int job) {
+        return QueueEntry(t.remainingTime(job), 0, 0, job);
+    }
+};
+
+// Ordered on a per-job key supplied by the Key policy above. A preemptive
+// key lets a newly admitted job take the CPU when it orders first.
+//
+// Small ready sets are kept flat with the primary keys in their own column
+// and selected with the SIMD kernels; past HEAP_ABOVE entries the same
+// array is turned into a binary heap, and back again below FLAT_BELOW.
+template <class Key>
+class KeyedQueue final : public ReadyQueue {
+private:
+    static const size_t HEAP_ABOVE = 64;
+    static const size_t FLAT_BELOW = 32;
+
+    const TaskStore* tasks;
+    std::vector<QueueEntry> entries;
+    std::vector<SimTime> keys;
+    bool heap_mode;
+    size_t last_scan;
+
+public:
+    KeyedQueue() : tasks(nullptr), heap_mode(false), last_scan(0) {}
+
+    std::unique_ptr<ReadyQueue> clone() const override {
+        return std::unique_ptr<ReadyQueue>(new KeyedQueue());
+    }
+    void reset(const TaskStore& t) override {
+        tasks = &t;
+        entries.clear();
+        keys.clear();
+        heap_mode = false;
+    }
+    void push(int job) override;
+    int pop() override;
+    bool empty() const override { return entries.empty(); }
+    size_t size() const override { return entries.size(); }
+    bool preempts(int arriving, int running) const override {
+        return Key::preemptive &&
+               Key::entry(*tasks, arriving) < Key::entry(*tasks, running);
+    }
+    size_t scanned() const override { return last_scan; }
+    void save(SnapshotWriter& out) const override;
+    void load(SnapshotReader& in) override;
+    void queued(std::vector<int>& jobs) const override {
+        for (size_t i = 0; i < entries.size(); i++) jobs.push_back(std::get<3>(entries[i]));
+    }
+};
+
+// Saved as the queued jobs in selection order, with the entries and keys
+// rebuilt from the store on load: a queued job's key has not changed since
+// it was pushed. The order is the same whatever the array's history, so
+// equal queues save equal bytes, and a sorted array is already a heap.
+template <class Key>
+void KeyedQueue<Key>::save(SnapshotWriter& out) const {
+    out.section("KEYD");
+    out.putString(Key::name());
+    out.put(static_cast<uint8_t>(heap_mode));
+    std::vector<QueueEntry> sorted(entries);
+    std::sort(sorted.begin(), sorted.end());
+    std::vector<int> jobs;
+    jobs.reserve(sorted.size());
+    for (size_t i = 0; i < sorted.size(); i++) jobs.push_back(std::get<3>(sorted[i]));
+    out.putVector(jobs);
+}
+
+template <class Key>
+void KeyedQueue<Key>::load(SnapshotReader& in) {
+    in.expect("KEYD");
+    if (in.getString() != Key::name()) in.fail("snapshot is of another policy");
+    heap_mode = in.get<uint8_t>() != 0;
+    size_t n;
+    const int* jobs = in.getArray<int>(n);
+    entries.clear();
+    keys.clear();
+    for (size_t i = 0; i < n; i++) {
+        if (jobs[i] < 0 || (size_t)jobs[i] >= tasks->size()) in.fail("queued job out of range");
+        entries.push_back(Key::entry(*tasks, jobs[i]));
+        if (!heap_mode) keys.push_back(std::get<0>(entries.back()));
+    }
+}
+
+template <class Key>
+void KeyedQueue<Key>::push(int job) {
+    entries.push_back(Key::entry(*tasks, job));
+    if (heap_mode) {
+        std::push_heap(entries.begin(), entries.end(), std::greater<QueueEntry>());
+        return;
+    }
+
+    keys.push_back(std::get<0>(entries.back()));
+    if (entries.size() > HEAP_ABOVE) {
+        std::make_heap(entries.begin(), entries.end(), std::greater<QueueEntry>());
+        keys.clear();
+        heap_mode = true;
+    }
+}
+
+template <class Key>
+int KeyedQueue<Key>::pop() {
+    if (heap_mode) {
+        // One sift-down: a pair of children per level
+        if (SCHED_STATS) last_scan = 2 * (64 - __builtin_clzll(entries.size()));
+        std::pop_heap(entries.begin(), entries.end(), std::greater<QueueEntry>());
+        int job = std::get<3>(entries.back());
+        entries.pop_back();
+
+        if (entries.size() < FLAT_BELOW) {
+            for (size_t i = 0; i < entries.size(); i++) {
+                keys.push_back(std::get<0>(entries[i]));
+            }
+            heap_mode = false;
+        }
+        return job;
+    }
+
+    // Vectorised min over the key column, then settle ties among equal keys
+    size_t n = keys.size();
+    if (SCHED_STATS) last_scan = n;
+    SimTime best_key = selectMin(keys.data(), n);
+    size_t best = selectFindEqual(keys.data(), n, 0, best_key);
+    for (size_t i = selectFindEqual(keys.data(), n, best + 1, best_key); i < n;
+         i = selectFindEqual(keys.data(), n, i + 1, best_key)) {
+        if (entries[i] < entries[best]) best = i;
+    }
+
+    int job = std::get<3>(entries[best]);
+    entries[best] = entries.back();
+    entries.pop_back();
+    keys[best] = keys.back();
+    keys.pop_back();
+    return job;
+}
+
+// MLFQ settings: one quantum per level, top level first
+struct MlfqConfig {
+    std::vector<SimTime> quanta;
+    SimTime boost_interval;   // every job back to the top level; 0 never
+    bool priority_entry;      // new jobs enter at level min(priority, last)
+
+    MlfqConfig() : boost_interval(0), priority_entry(false) {}
+
+    // `levels` levels with quanta doubling from `quantum`, boosted every
+    // eight lowest-level quanta
+    static MlfqConfig geometric(int levels, SimTime quantum);
+};
+
+// Multi-level feedback queue. Each level is an intrusive FIFO threaded
+// through a per-job next index, and a bitmap of non-empty levels picks the
+// next job with one find-first-set, so push and pop are O(1) whatever the
+// number of jobs or levels (at most 64).
+//
+// A job is demoted once it has used its level's quantum in total, across
+// preemptions. A job arriving at a higher level preempts the running one.
+// Every boost_interval the next dispatch first moves all jobs to the top.
+// Clones share the per-job state, so a job keeps its level when it moves
+// between CPUs.
+class MlfqQueue final : public ReadyQueue {
+public:
+    static const int MAX_LEVELS = 64;
+
+private:
+    struct Job {
+        int next;
+        int level;             // -1 until first admitted
+        unsigned epoch;        // boost epoch the level belongs to
+        bool on_cpu;
+        SimTime used;          // run time at this level
+        SimTime dispatched_remaining;
+    };
+
+    struct Shared {
+        std::vector<Job> jobs;
+        unsigned epoch;
+        SimTime next_boost;
+    };
+
+    MlfqConfig config;
+    std::shared_ptr<Shared> shared;
+    const TaskStore* tasks;
+    std::vector<int> heads;
+    std::vector<int> tails;
+    uint64_t nonempty;
+    size_t count;
+    unsigned local_epoch;
+    int dispatched;           // last job popped, for snapshots
+
+    Job& job(int j);
+    int levelOf(int j) const;
+    void charge(Job& s, int j);
+    void append(int level, int j);
+    void boost();
+
+public:
+    // Throws std::invalid_argument for no levels, more than MAX_LEVELS or
+    // a non-positive quantum
+    explicit MlfqQueue(const MlfqConfig& c);
+    // Replaces the settings of an idle queue, with the same checks
+    void configure(const MlfqConfig& c);
+
+    std::unique_ptr<ReadyQueue> clone() const override;
+    void reset(const TaskStore& t) override;
+    void push(int j) override;
+    int pop() override;
+    bool empty() const override { return count == 0; }
+    size_t size() const override { return count; }
+    void tick(SimTime now) override;
+    SimTime slice(int j, SimTime remaining) const override;
+    bool preempts(int arriving, int running) const override;
+    void block(int j) override;
+    // Saves the level FIFOs, the boost epoch and the per-job state of the
+    // queued and last dispatched jobs; load() needs the same number of
+    // levels
+    void save(SnapshotWriter& out) const override;
+    void load(SnapshotReader& in) override;
+    void queued(std::vector<int>& jobs) const override;
+};
+
+// CFS settings. A runnable job's slice is its weighted share of
+// target_latency, but never below min_granularity.
+struct FairConfig {
+    SimTime target_latency;
+    SimTime min_granularity;
+
+    FairConfig(SimTime latency = 24, SimTime granularity = 4)
+        : target_latency(latency), min_granularity(granularity) {}
+};
+
+// Completely fair scheduling: jobs are kept in a binary min-heap ordered by
+// virtual runtime (ties on index), the time they have run scaled by 1024 over
+// their weight, and the smallest runs next. Weights follow the Linux
+// nice-to-weight table with the task priority as the nice value (lower is
+// heavier), so each step costs a factor of about 1.25 in CPU share.
+// New jobs start at the queue's minimum vruntime, and a job waking from I/O
+// at no less than half a target latency behind it. An arrival preempts the
+// running job if it trails it by more than min_granularity of vruntime.
+// Clones share the per-job state, like MlfqQueue.
+class FairQueue final : public ReadyQueue {
+private:
+    struct Job {
+        double vruntime;
+        bool admitted;
+        bool on_cpu;
+        SimTime dispatched_remaining;
+    };
+
+    FairConfig config;
+    std::shared_ptr<std::vector<Job> > jobs;
+    const TaskStore* tasks;
+    typedef std::pair<double, int> Entry;
+    std::vector<Entry> heap;
+    double min_vruntime;
+    double queued_weight;
+    double running_weight;
+    size_t last_scan;
+    int dispatched;           // last job popped, for snapshots
+
+    Job& job(int j);
+    double currentVruntime(int j) const;
+
+public:
+    explicit FairQueue(const FairConfig& c = FairConfig());
+    void configure(const FairConfig& c) { config = c; }
+
+    // Load weight for a priority (nice value, clamped to -20..19)
+    static double weight(int priority);
+
+    std::unique_ptr<ReadyQueue> clone() const override;
+    void reset(const TaskStore& t) override;
+    void push(int j) override;
+    int pop() override;
+    bool empty() const override { return heap.empty(); }
+    size_t size() const override { return heap.size(); }
+    SimTime slice(int j, SimTime remaining) const override;
+    bool preempts(int arriving, int running) const override;
+    void block(int j) override;
+    size_t scanned() const override { return last_scan; }
+    // Saves the heap, the totals and the per-job state of the queued and
+    // last dispatched jobs
+    void save(SnapshotWriter& out) const override;
+    void load(SnapshotReader& in) override;
+    void queued(std::vector<int>& jobs) const override;
+};
+
+// Ready queue for a TaskScheduler algorithm name ("FCFS", "SJF", "SRTF",
+// "RR", "Priority", "MLFQ" or "CFS"), or null if the name is unknown. MLFQ
+// uses MlfqConfig::geometric(3, quantum) and CFS a minimum granularity of
+// quantum with six times that as target latency.
+std::unique_ptr<ReadyQueue> makeReadyQueue(const std::string& algorithm, SimTime quantum);
+
+// One queue of every policy, kept by callers that run many simulations so
+// each run reuses the storage of the last
+struct ReadyQueueSet {
+    FifoQueue fcfs;
+    KeyedQueue<BurstKey> sjf;
+    KeyedQueue<RemainingKey> srtf;
+    RoundRobinQueue rr;
+    KeyedQueue<PriorityKey> priority;
+    MlfqQueue mlfq;
+    FairQueue cfs;
+
+    // Every policy with makeReadyQueue()'s settings for quantum 4
+    ReadyQueueSet()
+        : rr(4), mlfq(MlfqConfig::geometric(3, 4)), cfs(FairConfig(24, 4)) {}
+    ReadyQueueSet(const std::string& algorithm, SimTime quantum) : ReadyQueueSet() {
+        configure(algorithm, quantum);
+    }
+
+    // Sets the quantum of the algorithm's policy as makeReadyQueue() would.
+    // The others are left alone, so a quantum only MLFQ rejects throws
+    // std::invalid_argument for MLFQ alone.
+    void configure(const std::string& algorithm, SimTime quantum) {
+        if (algorithm == "RR") {
+            rr.setQuantum(quantum);
+        } else if (algorithm == "MLFQ") {
+            mlfq.configure(MlfqConfig::geometric(3, quantum));
+        } else if (algorithm == "CFS") {
+            cfs.configure(FairConfig(6 * quantum, quantum));
+        }
+    }
+};
+
+// Calls visit(queue) with the set's statically typed queue for the
+// algorithm name, so whatever the visitor runs is compiled once per policy.
+// Returns false if the name is unknown.
+template <class Visitor>
+bool visitReadyQueue(ReadyQueueSet& set, const std::string& algorithm, Visitor& visit) {
+    if (algorithm == "FCFS") {
+        visit(set.fcfs);
+    } else if (algorithm == "SJF") {
+        visit(set.sjf);
+    } else if (algorithm == "SRTF") {
+        visit(set.srtf);
+    } else if (algorithm == "RR") {
+        visit(set.rr);
+    } else if (algorithm == "Priority") {
+        visit(set.priority);
+    } else if (algorithm == "MLFQ") {
+        visit(set.mlfq);
+    } else if (algorithm == "CFS") {
+        visit(set.cfs);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Engine state at one instant of a run, kept in memory for what-if reruns
+// (see whatif.h). Only the jobs in the system are stored, with the ready
+// queue's own state; tasks already finished or yet to arrive are recovered
+// from the run's outputs and the inputs.
+struct Checkpoint {
+    SimTime time;                    // every event up to here delivered
+    int running;
+    SimTime slice_end;               // of the running job
+    uint64_t next_arrival;
+    uint64_t completed;
+    uint64_t dispatches;
+    std::vector<int> active;         // queued and running jobs, ascending
+    std::vector<SimTime> remaining;  // at `time`, one per active job
+    std::vector<SimTime> starts;
+    std::vector<char> queue;         // ReadyQueue::save()
+};
+
+// Whether two runs are in the same state at a checkpoint, so they go on
+// identically while their inputs agree; dispatch counts may differ
+bool sameState(const Checkpoint& a, const Checkpoint& b);
+
+// Single-CPU discrete-event simulation core shared by Scheduler and
+// TaskScheduler. The clock only moves between events, so the cost of a run
+// depends on the number of arrivals and dispatches, not on burst lengths.
+//
+// Besides batch run(), the core can be driven online: start() opens a
+// session over the tasks already in the store, submit() admits more at any
+// time, and the advance calls deliver events up to a time or for a count.
+// Each event costs O(log n) in the event heap and ready queue.
+class EventSimulator {
+private:
+    TaskStore& tasks;
+    EventQueue events;
+    const std::vector<int>* arrival_order;
+    ReadyQueue* online;
+    StreamingMetrics* sink;
+    ResultSink* results;
+    Timeline* timeline;
+    SimTime current_time;
+    int running;
+    SimTime run_since;
+    unsigned dispatch_tag;
+    unsigned submit_seq;
+    size_t dispatch_count;
+    size_t completed;
+    std::vector<int> finished;
+
+    // Round Robin fast-forward: scratch kept across runs, and the dispatches
+    // left before the next attempt
+    struct RoundScratch {
+        std::vector<SimTime> sorted;
+        std::vector<SimTime> prefix;
+        std::vector<SimTime> rounds;
+        std::vector<int> order;
+        std::vector<int> tree;
+        std::vector<int> survivors;
+        std::vector<std::pair<SimTime, int> > finishing;
+    };
+    RoundScratch scratch;
+    size_t rotation_left;
+    // Instrumentation, updated only in SCHED_STATS builds
+    SchedulerCounters stats;
+    int last_job;
+    SimTime slice_end;
+    // Pending snapshotAt(), or -1
+    SimTime snapshot_time;
+    std::string snapshot_path;
+    // Checkpoints: every `checkpoint_interval` time units (0 for none)
+    // into `checkpoint_log`, and compared against `baseline` from
+    // `converge_from` on
+    SimTime checkpoint_interval;
+    SimTime next_checkpoint;
+    std::vector<Checkpoint>* checkpoint_log;
+    const std::vector<Checkpoint>* baseline;
+    SimTime converge_from;
+    const std::vector<int>* changed;
+    const Checkpoint* converged_at;
+    Checkpoint probe;
+    // Next time the loop pauses for a snapshot or checkpoint, or -1
+    SimTime next_stop;
+
+    void begin(ReadyQueue& queue);
+    template <class Queue> void proceed(Queue& queue);
+    void save(const ReadyQueue& queue);
+    void restore(ReadyQueue& queue, const std::string& path);
+    void restore(ReadyQueue& queue, const Checkpoint& from, const TaskStore& prior);
+    void capture(const ReadyQueue& queue, SimTime at, Checkpoint& c);
+    bool likeBaseline(const Checkpoint& base, const ReadyQueue& queue) const;
+    bool pause(const ReadyQueue& queue);
+    void planStops();
+    template <class Queue> void deliver(const Event& e, Queue& queue);
+    template <class Queue> void dispatch(Queue& queue);
+    // Applies whole rounds in closed form before a dispatch; only Round
+    // Robin has a fixed rotation to skip
+    template <class Queue> void skipRounds(Queue& queue) { (void)queue; }
+    void skipRounds(RoundRobinQueue& queue);
+    void countSkipped(const JobRing& ring, SimTime rounds, uint64_t slices);
+    void retire(int job, SimTime at) {
+        tasks.completionTime(job) = at;
+        completed++;
+        if (online) finished.push_back(job);
+        if (sink) sink->record(tasks.arrivalTime(job), tasks.burstTime(job), at);
+        if (results) results->write(tasks, job);
+    }
+    size_t advance(SimTime until, size_t max_events);
+    void account();
+
+public:
+    // Results are written back into the store's output columns
+    explicit EventSimulator(TaskStore& store)
+        : tasks(store), arrival_order(nullptr), online(nullptr), sink(nullptr),
+          results(nullptr), timeline(nullptr), current_time(0),
+          running(-1), run_since(0), dispatch_tag(0), submit_seq(0),
+          dispatch_count(0), completed(0), rotation_left(0), last_job(-1),
+          slice_end(0), snapshot_time(-1), checkpoint_interval(0), next_checkpoint(0),
+          checkpoint_log(nullptr), baseline(nullptr), converge_from(0), changed(nullptr),
+          converged_at(nullptr), next_stop(-1) {}
+
+    // Reuses a precomputed arrivalOrder() for every later run instead of
+    // sorting per run; it must outlive the simulator and may be shared
+    void useArrivalOrder(const std::vector<int>& order) { arrival_order = &order; }
+
+    // Runs every task to completion. Instantiated on a concrete policy the
+    // loop is specialised for it; on ReadyQueue it dispatches virtually.
+    // On RoundRobinQueue, rounds that end before the next arrival are
+    // computed in closed form, so the cost follows arrivals and completions
+    // rather than quantum slices (not while recording a timeline).
+    template <class Queue> void run(Queue& queue);
+
+    // Makes the next run() write its state to `path` (see snapshot.h) once
+    // every event up to `time` has been delivered: the clock, running job
+    // and pending events, remaining and start times, completions so far,
+    // the ready queue and any recordInto() metrics. A run finishing before
+    // `time` writes its final state. Throws std::runtime_error if the file
+    // can't be written; the timeline and streamed results are not saved.
+    void snapshotAt(SimTime time, const std::string& path) {
+        snapshot_time = time;
+        snapshot_path = path;
+    }
+    // Continues a run() from a snapshot taken on the same tasks and the
+    // same policy, mapping the file rather than reading it. The results,
+    // dispatches, counters and recordInto() metrics come out as those of
+    // the uninterrupted run. Throws std::runtime_error for a snapshot of
+    // other tasks or another policy, or a malformed file.
+    template <class Queue> void resume(Queue& queue, const std::string& path);
+
+    // Appends a Checkpoint to `log` at every multiple of `interval` that
+    // later runs pass with events since the last one; a null log with a
+    // positive interval only paces convergeTo(), and 0 stops both
+    void checkpointEvery(SimTime interval, std::vector<Checkpoint>* log) {
+        checkpoint_interval = interval > 0 ? interval : 0;
+        checkpoint_log = log;
+    }
+    // Ends later runs at the first checkpoint from `from` on that is in the
+    // same state as `base`'s at that time with none of the `edited` jobs
+    // left in the system; converged() then names it. `from` must not be
+    // before any edited job arrives. Both vectors must outlive the runs; a
+    // null `base` stops it.
+    void convergeTo(const std::vector<Checkpoint>* base, SimTime from,
+                    const std::vector<int>* edited) {
+        baseline = base;
+        converge_from = from;
+        changed = edited;
+    }
+    // Continues a run() from a checkpoint of an earlier run over these
+    // tasks, whose inputs may differ only in tasks arriving after
+    // `from.time`; tasks that had finished take their times from that
+    // run's final outputs in `prior`. Counters start from zero.
+    template <class Queue> void rerun(Queue& queue, const Checkpoint& from, const TaskStore& prior);
+    // Baseline checkpoint the last run ended at under convergeTo(), or null
+    const Checkpoint* converged() const { return converged_at; }
+
+    // Feeds every completion into `metrics` as it happens; null stops it
+    void recordInto(StreamingMetrics* metrics) { sink = metrics; }
+
+    // Writes every task to `s` as it completes; null stops it
+    void streamTo(ResultSink* s) { results = s; }
+
+    // Appends every slice of CPU time to `t` on CPU 0; a no-op unless built
+    // with SCHED_TIMELINE
+    void recordTimeline(Timeline* t) { timeline = t; }
+
+    // Opens an online session; the queue must outlive it
+    void start(ReadyQueue& queue);
+    // Admits a task arriving at or after now(); returns its store index.
+    // Throws std::logic_error outside a session and std::invalid_argument
+    // for an arrival in the past.
+    int submit(int id, SimTime arrival, SimTime burst, int priority = 0);
+    // Delivers every event up to and including `time`, then moves the clock
+    // there; returns the number of events delivered
+    size_t advanceUntil(SimTime time);
+    // Delivers at most `count` events
+    size_t advanceEvents(size_t count);
+    // Appends the indices of tasks completed since the last drain
+    void drainCompletions(std::vector<int>& jobs);
+    // Submitted tasks not yet completed
+    size_t pending() const { return tasks.size() - completed; }
+
+    size_t size() const { return tasks.size(); }
+    SimTime now() const { return current_time; }
+    // Scheduling decisions (dispatches) made by the last run
+    size_t dispatches() const { return dispatch_count; }
+    // Dispatcher counters and phase timings since the last run or session
+    // began; all zero unless built with SCHED_STATS
+    const SchedulerCounters& counters() const { return stats; }
+    const TaskStore& store() const { return tasks; }
+    SimTime remaining(int i) const { return tasks.remainingTime(i); }
+};
+
+template <class Queue>
+void EventSimulator::run(Queue& queue) {
+    begin(queue);
+    proceed(queue);
+}
+
+template <class Queue>
+void EventSimulator::resume(Queue& queue, const std::string& path) {
+    begin(queue);
+    restore(queue, path);
+    proceed(queue);
+}
+
+template <class Queue>
+void EventSimulator::rerun(Queue& queue, const Checkpoint& from, const TaskStore& prior) {
+    begin(queue);
+    restore(queue, from, prior);
+    proceed(queue);
+}
+
+template <class Queue>
+void EventSimulator::proceed(Queue& queue) {
+    size_t n = tasks.size();
+    while (completed < n) {
+        if (running < 0 && !queue.empty()) {
+            skipRounds(queue);
+            if (queue.empty()) continue;
+            dispatch(queue);
+        }
+        if (next_stop >= 0 && (events.empty() || events.nextTime() > next_stop)) {
+            if (pause(queue)) return;
+        }
+
+        // Deliver every event at the next instant before dispatching again
+        SimTime next = events.nextTime();
+        if (SCHED_STATS && running < 0 && next > current_time) {
+            stats.idle_periods++;
+            stats.idle_time += next - current_time;
+        }
+        current_time = next;
+        while (!events.empty() && events.nextTime() == current_time) {
+            deliver(events.pop(), queue);
+        }
+    }
+    if (snapshot_time >= 0) save(queue);
+}
+
+template <class Queue>
+void EventSimulator::deliver(const Event& e, Queue& queue) {
+    if (e.type == EVENT_ARRIVAL) {
+        PhaseTimer timer(stats, PHASE_ADMISSION);
+        queue.push(e.job);
+        if (running >= 0) {
+            account();
+            if (tasks.remainingTime(running) > 0 && queue.preempts(e.job, running)) {
+                if (SCHED_STATS) stats.preemptions++;
+                queue.push(running);
+                running = -1;
+            }
+        }
+    } else if (e.job == running && e.tag == dispatch_tag) {
+        PhaseTimer timer(stats, PHASE_ACCOUNTING);
+        account();
+        if (tasks.remainingTime(running) > 0) {
+            queue.push(running);
+        } else {
+            retire(running, current_time);
+        }
+        running = -1;
+    }
+}
+
+template <class Queue>
+void EventSimulator::dispatch(Queue& queue) {
+    PhaseTimer timer(stats, PHASE_SELECTION);
+    size_t length = queue.size();
+    queue.tick(current_time);
+    running = queue.pop();
+    if (SCHED_STATS) {
+        stats.sampleQueue(length, queue.scanned());
+        stats.dispatches++;
+        if (running != last_job) stats.context_switches++;
+        last_job = running;
+    }
+    if (tasks.startTime(running) < 0) {
+        tasks.startTime(running) = current_time;
+    }
+    run_since = current_time;
+    dispatch_tag++;
+    dispatch_count++;
+
+    slice_end = current_time + queue.slice(running, tasks.remainingTime(running));
+    events.schedule(Event(slice_end, EVENT_SLICE_END, running, dispatch_tag));
+}
+
+#endif
@@ -0,0 +1,170 @@
+#include "smp.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+SmpSimulator::SmpSimulator(TaskStore& store, int cpus)
+    : tasks(store), cores(std::max(cpus, 1)), current_time(0), dispatch_count(0),
+      timeline(nullptr), results(nullptr) {}
+
+void SmpSimulator::run(const ReadyQueue& policy) {
+    size_t n = tasks.size();
+    tasks.resetOutputs();
+    events.reset(tasks);
+    current_time = 0;
+    dispatch_count = 0;
+    counts.clear();
+    
+    for (size_t c = 0; c < cores.size(); c++) {
+        cores[c].queue = policy.clone();
+        cores[c].queue->reset(tasks);
+        cores[c].running = -1;
+        cores[c].run_since = 0;
+        cores[c].dispatch_tag = 0;
+        cores[c].last_job = -1;
+        cores[c].stats = CoreStats();
+    }
+    
+    size_t completed = 0;
+    while (completed < n) {
+        for (size_t c = 0; c < cores.size(); c++) {
+            if (cores[c].running >= 0) continue;
+            if (cores[c].queue->empty()) steal(c);
+            if (!cores[c].queue->empty()) dispatch(c);
+        }
+        
+        // Deliver every event at the next instant before dispatching again
+        SimTime next = events.nextTime();
+        if (SCHED_STATS) {
+            for (size_t c = 0; c < cores.size(); c++) {
+                if (cores[c].running < 0 && next > current_time) counts.idle_periods++;
+            }
+        }
+        current_time = next;
+        while (!events.empty() && events.nextTime() == current_time) {
+            Event e = events.pop();
+            
+            if (e.type == EVENT_ARRIVAL) {
+                PhaseTimer timer(counts, PHASE_ADMISSION);
+                int cpu = place();
+                Core& core = cores[cpu];
+                core.queue->push(e.job);
+                if (core.running >= 0) {
+                    account(cpu);
+                    if (tasks.remainingTime(core.running) > 0 &&
+                        core.queue->preempts(e.job, core.running)) {
+                        if (SCHED_STATS) counts.preemptions++;
+                        core.queue->push(core.running);
+                        core.running = -1;
+                    }
+                }
+            } else {
+                Core& core = cores[e.cpu];
+                if (e.job != core.running || e.tag != core.dispatch_tag) continue;
+                PhaseTimer timer(counts, PHASE_ACCOUNTING);
+                
+                account(e.cpu);
+                if (tasks.remainingTime(core.running) > 0) {
+                    core.queue->push(core.running);
+                } else {
+                    tasks.completionTime(core.running) = current_time;
+                    core.stats.completed++;
+                    completed++;
+                    if (results) results->write(tasks, core.running);
+                }
+                core.running = -1;
+            }
+        }
+    }
+    
+    if (SCHED_STATS) {
+        for (size_t c = 0; c < cores.size(); c++) {
+            counts.idle_time += current_time - cores[c].stats.busy_time;
+        }
+    }
+}
+
+// Idle CPU with an empty queue if any, else the shortest queue
+int SmpSimulator::place() const {
+    int best = 0;
+    for (size_t c = 0; c < cores.size(); c++) {
+        if (cores[c].running < 0 && cores[c].queue->empty()) return c;
+        if (cores[c].queue->size() < cores[best].queue->size()) best = c;
+    }
+    return best;
+}
+
+void SmpSimulator::steal(int cpu) {
+    int victim = -1;
+    for (size_t c = 0; c < cores.size(); c++) {
+        if (cores[c].queue->empty()) continue;
+        if (victim < 0 || cores[c].queue->size() > cores[victim].queue->size()) victim = c;
+    }
+    if (victim < 0) return;
+    
+    cores[cpu].queue->push(cores[victim].queue->pop());
+    cores[cpu].stats.steals++;
+}
+
+void SmpSimulator::dispatch(int cpu) {
+    Core& core = cores[cpu];
+    PhaseTimer timer(counts, PHASE_SELECTION);
+    size_t length = core.queue->size();
+    core.queue->tick(current_time);
+    core.running = core.queue->pop();
+    if (SCHED_STATS) {
+        counts.sampleQueue(length, core.queue->scanned());
+        counts.dispatches++;
+        if (core.running != core.last_job) counts.context_switches++;
+        core.last_job = core.running;
+    }
+    if (tasks.startTime(core.running) < 0) {
+        tasks.startTime(core.running) = current_time;
+    }
+    core.run_since = current_time;
+    core.dispatch_tag++;
+    core.stats.dispatches++;
+    dispatch_count++;
+    
+    SimTime slice = core.queue->slice(core.running, tasks.remainingTime(core.running));
+    events.schedule(Event(current_time + slice, EVENT_SLICE_END, core.running,
+                          core.dispatch_tag, cpu));
+}
+
+void SmpSimulator::account(int cpu) {
+    Core& core = cores[cpu];
+    if (SCHED_TIMELINE && timeline) {
+        timeline->record(tasks.taskId(core.running), cpu, core.run_since, current_time);
+    }
+    SimTime ran = current_time - core.run_since;
+    tasks.remainingTime(core.running) -= ran;
+    core.stats.busy_time += ran;
+    core.run_since = current_time;
+}
+
+std::vector<CoreStats> SmpSimulator::coreStats() const {
+    std::vector<CoreStats> stats;
+    for (size_t c = 0; c < cores.size(); c++) stats.push_back(cores[c].stats);
+    return stats;
+}
+
+void printCoreStats(const std::vector<CoreStats>& cores, SimTime span) {
+    std::cout << "\n--- Per-CPU Metrics ---\n";
+    std::cout << "CPU\tBusy\tUtilization\tDispatches\tCompleted\tSteals\n";
+    
+    double total_busy = 0, max_busy = 0;
+    for (size_t c = 0; c < cores.size(); c++) {
+        const CoreStats& s = cores[c];
+        double utilization = span > 0 ? 100.0 * s.busy_time / span : 0;
+        std::cout << "CPU" << c << "\t" << s.busy_time << "\t"
+                  << utilization << "%\t\t"
+                  << s.dispatches << "\t\t" << s.completed << "\t\t"
+                  << s.steals << "\n";
+        total_busy += s.busy_time;
+        max_busy = std::max(max_busy, static_cast<double>(s.busy_time));
+    }
+    
+    double mean_busy = cores.empty() ? 0 : total_busy / cores.size();
+    double imbalance = mean_busy > 0 ? (max_busy / mean_busy - 1) * 100 : 0;
+    std::cout << "Load Imbalance: " << imbalance << "%\n";
+}
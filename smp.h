@@ -0,0 +1,75 @@
+#ifndef SMP_H
+#define SMP_H
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include "simulation.h"
+
+// Per-CPU accounting from an SMP run
+struct CoreStats {
+    SimTime busy_time;
+    size_t dispatches;
+    size_t completed;
+    size_t steals;      // jobs this CPU took from another CPU's queue
+    
+    CoreStats() : busy_time(0), dispatches(0), completed(0), steals(0) {}
+};
+
+// N-CPU discrete-event simulation. Every CPU owns a run queue cloned from
+// the policy's queue. An arrival goes to an idle CPU if there is one,
+// otherwise to the CPU with the shortest run queue (and may preempt its
+// running job under a preemptive policy). A CPU whose queue runs dry
+// steals the next job from the longest queue.
+class SmpSimulator {
+private:
+    struct Core {
+        std::unique_ptr<ReadyQueue> queue;
+        int running;
+        SimTime run_since;
+        unsigned dispatch_tag;
+        int last_job;
+        CoreStats stats;
+    };
+    
+    TaskStore& tasks;
+    std::vector<Core> cores;
+    EventQueue events;
+    SimTime current_time;
+    size_t dispatch_count;
+    Timeline* timeline;
+    ResultSink* results;
+    SchedulerCounters counts;   // updated only in SCHED_STATS builds
+    
+    int place() const;
+    void steal(int cpu);
+    void dispatch(int cpu);
+    void account(int cpu);
+    
+public:
+    // Results are written back into the store's output columns
+    SmpSimulator(TaskStore& store, int cpus);
+    
+    void run(const ReadyQueue& policy);
+    
+    // Appends every slice of CPU time to `t`; a no-op unless built with
+    // SCHED_TIMELINE
+    void recordTimeline(Timeline* t) { timeline = t; }
+    
+    // Writes every task to `s` as it completes; null stops it
+    void streamTo(ResultSink* s) { results = s; }
+    
+    int cpus() const { return cores.size(); }
+    SimTime now() const { return current_time; }
+    size_t dispatches() const { return dispatch_count; }
+    // Dispatcher counters and phase timings of the last run, summed over
+    // CPUs; all zero unless built with SCHED_STATS
+    const SchedulerCounters& counters() const { return counts; }
+    std::vector<CoreStats> coreStats() const;
+};
+
+// Prints per-CPU utilisation over `span` time units and the load imbalance
+// (busiest CPU's busy time over the mean, minus one)
+void printCoreStats(const std::vector<CoreStats>& cores, SimTime span);
+
+#endif
@@ -0,0 +1,116 @@
+#include "snapshot.h"
+#include "mapped_file.h"
+#include <stdexcept>
+
+namespace {
+
+const char SNAPSHOT_MAGIC[8] = { 'L', 'A', 'B', 'S', 'N', 'A', 'P', 'S' };
+
+bool littleEndian() {
+    uint16_t probe = 1;
+    return *reinterpret_cast<const unsigned char*>(&probe) == 1;
+}
+
+uint64_t fnv(uint64_t hash, const void* data, size_t bytes) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < bytes; i++) {
+        hash = (hash ^ p[i]) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+}
+
+uint64_t hashInputs(const TaskStore& tasks) {
+    size_t n = tasks.size();
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    hash = fnv(hash, tasks.idData(), n * sizeof(int));
+    hash = fnv(hash, tasks.arrivalData(), n * sizeof(SimTime));
+    hash = fnv(hash, tasks.burstData(), n * sizeof(SimTime));
+    hash = fnv(hash, tasks.priorityData(), n * sizeof(int));
+    return hash;
+}
+
+// Writer
+SnapshotWriter::SnapshotWriter(const std::string& path)
+    : memory(nullptr), offset(0) {
+    if (!littleEndian()) {
+        throw std::runtime_error("snapshots require a little-endian host");
+    }
+    out.reset(new OutputBuffer(path));
+}
+
+SnapshotWriter::SnapshotWriter(std::vector<char>& buffer)
+    : memory(&buffer), offset(buffer.size()) {}
+
+void SnapshotWriter::writeHeader(const TaskStore& tasks, SimTime clock) {
+    SnapshotHeader h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, SNAPSHOT_MAGIC, sizeof(h.magic));
+    h.version = SNAPSHOT_VERSION;
+    h.task_count = tasks.size();
+    h.input_hash = hashInputs(tasks);
+    h.clock = clock;
+    put(h);
+}
+
+void SnapshotWriter::pad() {
+    static const char zeros[8] = { 0 };
+    put(zeros, (8 - offset % 8) % 8);
+}
+
+void SnapshotWriter::section(const char tag[4]) {
+    static const char zeros[4] = { 0 };
+    pad();
+    put(tag, 4);
+    put(zeros, 4);
+}
+
+// Reader
+SnapshotReader::SnapshotReader(const std::string& p)
+    : file(std::make_shared<MappedFile>(p)), data(file->data()), size(file->size()),
+      offset(sizeof(SnapshotHeader)), path(p) {
+    if (size < sizeof(SnapshotHeader) ||
+        std::memcmp(data, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0) {
+        fail("not a snapshot");
+    }
+    if (header().version != SNAPSHOT_VERSION) {
+        fail("unsupported snapshot version " + std::to_string(header().version));
+    }
+}
+
+SnapshotReader::SnapshotReader(const std::vector<char>& buffer, const std::string& name)
+    : data(buffer.data()), size(buffer.size()), offset(0), path(name) {}
+
+void SnapshotReader::checkWorkload(const TaskStore& tasks) const {
+    if (header().task_count != tasks.size()) {
+        fail("snapshot has " + std::to_string(header().task_count) + " tasks, workload has " +
+             std::to_string(tasks.size()));
+    }
+    if (header().input_hash != hashInputs(tasks)) {
+        fail("snapshot was taken on a different workload");
+    }
+}
+
+const char* SnapshotReader::take(size_t bytes) {
+    if (bytes > size - offset) fail("truncated snapshot");
+    const char* p = data + offset;
+    offset += bytes;
+    return p;
+}
+
+void SnapshotReader::pad() {
+    take((8 - offset % 8) % 8);
+}
+
+void SnapshotReader::expect(const char tag[4]) {
+    pad();
+    const char* found = take(8);
+    if (std::memcmp(found, tag, 4) != 0) {
+        fail("expected section " + std::string(tag, 4) + ", found " + std::string(found, 4));
+    }
+}
+
+void SnapshotReader::fail(const std::string& what) const {
+    throw std::runtime_error(path + ": " + what);
+}
@@ -0,0 +1,156 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+#include "task_store.h"
+#include "results.h"
+
+class MappedFile;
+
+// Snapshot layout (version 1, little-endian):
+//
+//   SnapshotHeader                             64 bytes
+//   sections, each a 4-byte tag and 4 bytes of padding followed by its
+//   fields; arrays are a uint64 length and the elements, both starting on
+//   an 8-byte boundary
+//
+// The sections are written by EventSimulator and the ready queues in a
+// fixed order, so a reader takes them in the same order and checks each
+// tag. Arrays are 8-byte aligned in the file and read straight out of the
+// mapping.
+const uint32_t SNAPSHOT_VERSION = 1;
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+    uint64_t task_count;
+    uint64_t input_hash;   // hashInputs() of the workload
+    int64_t clock;
+    uint64_t reserved[3];
+};
+
+// FNV-1a over the input columns, so a snapshot is only resumed on the
+// workload it was taken from
+uint64_t hashInputs(const TaskStore& tasks);
+
+class SnapshotWriter {
+private:
+    std::unique_ptr<OutputBuffer> out;
+    std::vector<char>* memory;
+    size_t offset;
+
+    void pad();
+
+public:
+    // Throws std::runtime_error if the file can't be created
+    explicit SnapshotWriter(const std::string& path);
+    // Appends sections to `buffer` instead, without a header, e.g. for
+    // in-memory checkpoints
+    explicit SnapshotWriter(std::vector<char>& buffer);
+
+    // Must come first in a file
+    void writeHeader(const TaskStore& tasks, SimTime clock);
+
+    void put(const void* data, size_t bytes) {
+        if (memory) {
+            const char* p = static_cast<const char*>(data);
+            memory->insert(memory->end(), p, p + bytes);
+        } else {
+            out->putBytes(data, bytes);
+        }
+        offset += bytes;
+    }
+    template <class T> void put(const T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot fields are raw bytes");
+        put(&value, sizeof(T));
+    }
+    template <class T> void putArray(const T* data, size_t n) {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot fields are raw bytes");
+        pad();
+        put(static_cast<uint64_t>(n));
+        put(static_cast<const void*>(data), n * sizeof(T));
+        pad();
+    }
+    template <class T> void putVector(const std::vector<T>& v) { putArray(v.data(), v.size()); }
+    void putString(const std::string& s) { putArray(s.data(), s.size()); }
+    // Starts a section, on an 8-byte boundary
+    void section(const char tag[4]);
+    // Flushes the file; throws std::runtime_error if the write fails
+    void finish() {
+        if (out) out->flush();
+    }
+};
+
+// Reads a snapshot through a read-only mapping. Every read is bounds
+// checked; a short or malformed file throws std::runtime_error.
+class SnapshotReader {
+private:
+    std::shared_ptr<MappedFile> file;
+    const char* data;
+    size_t size;
+    size_t offset;
+    std::string path;
+
+    const char* take(size_t bytes);
+    void pad();
+
+public:
+    // Throws std::runtime_error if the file is not a version 1 snapshot
+    explicit SnapshotReader(const std::string& path);
+    // Reads headerless sections from a SnapshotWriter's buffer, which must
+    // outlive the reader; header() and checkWorkload() are not available
+    SnapshotReader(const std::vector<char>& buffer, const std::string& name);
+
+    const SnapshotHeader& header() const {
+        return *reinterpret_cast<const SnapshotHeader*>(data);
+    }
+
+    template <class T> T get() {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot fields are raw bytes");
+        T value;
+        std::memcpy(&value, take(sizeof(T)), sizeof(T));
+        return value;
+    }
+    // Points into the mapping, valid while the reader lives
+    template <class T> const T* getArray(size_t& n) {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot fields are raw bytes");
+        pad();
+        n = get<uint64_t>();
+        if (n > size / sizeof(T)) fail("array larger than the file");
+        const T* items = reinterpret_cast<const T*>(take(n * sizeof(T)));
+        pad();
+        return items;
+    }
+    // An array that must have `rows` elements
+    template <class T> const T* getColumn(size_t rows) {
+        size_t n;
+        const T* items = getArray<T>(n);
+        if (n != rows) fail("column has the wrong length");
+        return items;
+    }
+    template <class T> void getVector(std::vector<T>& v) {
+        size_t n;
+        const T* items = getArray<T>(n);
+        v.assign(items, items + n);
+    }
+    std::string getString() {
+        size_t n;
+        const char* chars = getArray<char>(n);
+        return std::string(chars, n);
+    }
+    // Throws unless the snapshot was taken on these inputs
+    void checkWorkload(const TaskStore& tasks) const;
+    // Throws unless the next section has this tag
+    void expect(const char tag[4]);
+    // Throws std::runtime_error naming the file
+    void fail(const std::string& what) const;
+};
+
+#endif
@@ -0,0 +1,164 @@
+#include "task_store.h"
+#include <algorithm>
+
+namespace {
+
+template <typename T>
+void permute(std::vector<T>& column, const std::vector<size_t>& order) {
+    std::vector<T> sorted;
+    sorted.reserve(column.size());
+    for (size_t i = 0; i < order.size(); i++) sorted.push_back(column[order[i]]);
+    column.swap(sorted);
+}
+
+}
+
+TaskStore::TaskStore()
+    : id_col(nullptr), arrival_col(nullptr), burst_col(nullptr),
+      priority_col(nullptr), count(0), shared_inputs(false) {}
+
+TaskStore::TaskStore(const TaskStore& other)
+    : ids(other.ids), arrivals(other.arrivals), bursts(other.bursts),
+      priorities(other.priorities), id_col(other.id_col),
+      arrival_col(other.arrival_col), burst_col(other.burst_col),
+      priority_col(other.priority_col), count(other.count),
+      shared_inputs(other.shared_inputs), backing(other.backing), remaining(other.remaining),
+      starts(other.starts), completions(other.completions) {
+    if (!shared_inputs) sync();
+}
+
+TaskStore& TaskStore::operator=(const TaskStore& other) {
+    if (this != &other) {
+        TaskStore copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+// Points the input columns at the owned vectors
+void TaskStore::sync() {
+    id_col = ids.data();
+    arrival_col = arrivals.data();
+    burst_col = bursts.data();
+    priority_col = priorities.data();
+    count = ids.size();
+}
+
+// Copies borrowed inputs into owned vectors so they can be modified
+void TaskStore::own() {
+    if (!shared_inputs) return;
+    ids.assign(id_col, id_col + count);
+    arrivals.assign(arrival_col, arrival_col + count);
+    bursts.assign(burst_col, burst_col + count);
+    priorities.assign(priority_col, priority_col + count);
+    shared_inputs = false;
+    backing.reset();
+    sync();
+}
+
+void TaskStore::reserve(size_t n) {
+    own();
+    ids.reserve(n);
+    arrivals.reserve(n);
+    bursts.reserve(n);
+    priorities.reserve(n);
+    remaining.reserve(n);
+    starts.reserve(n);
+    completions.reserve(n);
+    sync();
+}
+
+void TaskStore::clear() {
+    shared_inputs = false;
+    backing.reset();
+    ids.clear();
+    arrivals.clear();
+    bursts.clear();
+    priorities.clear();
+    remaining.clear();
+    starts.clear();
+    completions.clear();
+    sync();
+}
+
+void TaskStore::add(int id, SimTime arrival, SimTime burst, int priority) {
+    own();
+    ids.push_back(id);
+    arrivals.push_back(arrival);
+    bursts.push_back(burst);
+    priorities.push_back(priority);
+    remaining.push_back(burst);
+    starts.push_back(-1);
+    completions.push_back(0);
+    sync();
+}
+
+void TaskStore::setInputs(size_t i, SimTime arrival, SimTime burst, int priority) {
+    own();
+    arrivals[i] = arrival;
+    bursts[i] = burst;
+    priorities[i] = priority;
+}
+
+void TaskStore::attach(size_t n, const int* id_column, const SimTime* arrival_column,
+                       const SimTime* burst_column, const int* priority_column,
+                       std::shared_ptr<const void> keep_alive) {
+    clear();
+    id_col = id_column;
+    arrival_col = arrival_column;
+    burst_col = burst_column;
+    priority_col = priority_column;
+    count = n;
+    shared_inputs = true;
+    backing = keep_alive;
+    
+    remaining.assign(burst_col, burst_col + n);
+    starts.assign(n, -1);
+    completions.assign(n, 0);
+}
+
+TaskStore TaskStore::view() const {
+    TaskStore v;
+    v.id_col = id_col;
+    v.arrival_col = arrival_col;
+    v.burst_col = burst_col;
+    v.priority_col = priority_col;
+    v.count = count;
+    v.shared_inputs = true;
+    v.backing = backing;
+    v.resetOutputs();
+    return v;
+}
+
+void TaskStore::resetOutputs() {
+    remaining.assign(burst_col, burst_col + count);
+    starts.assign(count, -1);
+    completions.assign(count, 0);
+}
+
+void TaskStore::restoreOutputs(const SimTime* remaining_column, const SimTime* start_column,
+                               const SimTime* completion_column) {
+    remaining.assign(remaining_column, remaining_column + count);
+    starts.assign(start_column, start_column + count);
+    completions.assign(completion_column, completion_column + count);
+}
+
+void TaskStore::sortByArrival() {
+    if (std::is_sorted(arrival_col, arrival_col + count)) return;
+    own();
+    std::vector<size_t> order(size());
+    for (size_t i = 0; i < order.size(); i++) order[i] = i;
+    std::stable_sort(order.begin(), order.end(),
+                     [this](size_t a, size_t b) {
+                         return arrivals[a] < arrivals[b];
+                     });
+    
+    permute(ids, order);
+    permute(arrivals, order);
+    permute(bursts, order);
+    permute(priorities, order);
+    permute(remaining, order);
+    permute(starts, order);
+    permute(completions, order);
+    sync();
+}
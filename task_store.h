@@ -0,0 +1,106 @@
+#ifndef TASK_STORE_H
+#define TASK_STORE_H
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+// Simulation time. 64-bit so long traces at fine resolution (e.g. a day in
+// microseconds) cannot overflow.
+typedef int64_t SimTime;
+
+// Columnar task storage used by the simulation core. Inputs and outputs
+// live in separate arrays so a selection pass only pulls the columns it
+// actually reads into cache.
+//
+// Input columns are either owned or borrowed from external memory such as
+// a mapped binary trace (see attach()). Outputs are always owned.
+class TaskStore {
+private:
+    // Owned inputs
+    std::vector<int> ids;
+    std::vector<SimTime> arrivals;
+    std::vector<SimTime> bursts;
+    std::vector<int> priorities;
+    
+    // Input columns in use: the vectors above, or borrowed memory
+    const int* id_col;
+    const SimTime* arrival_col;
+    const SimTime* burst_col;
+    const int* priority_col;
+    size_t count;
+    bool shared_inputs;
+    std::shared_ptr<const void> backing;
+    
+    // Outputs
+    std::vector<SimTime> remaining;
+    std::vector<SimTime> starts;
+    std::vector<SimTime> completions;
+    
+    void own();
+    void sync();
+    
+public:
+    TaskStore();
+    TaskStore(const TaskStore& other);
+    TaskStore& operator=(const TaskStore& other);
+    TaskStore(TaskStore&& other) = default;
+    TaskStore& operator=(TaskStore&& other) = default;
+    
+    void reserve(size_t n);
+    void clear();
+    void add(int id, SimTime arrival, SimTime burst, int priority = 0);
+    // Changes one task's inputs, copying borrowed columns first
+    void setInputs(size_t i, SimTime arrival, SimTime burst, int priority);
+    
+    // Replaces the inputs with n rows of external columns used in place.
+    // `keep_alive` owns that memory and is held until the store lets go.
+    void attach(size_t n, const int* id_column, const SimTime* arrival_column,
+                const SimTime* burst_column, const int* priority_column,
+                std::shared_ptr<const void> keep_alive);
+    bool borrowed() const { return shared_inputs; }
+    
+    // A store over the same input columns with its own outputs, for running
+    // several simulations over one workload. This store (or whatever it
+    // borrows from) must outlive the view.
+    TaskStore view() const;
+    
+    // Sets remaining = burst and clears start/completion for a fresh run
+    void resetOutputs();
+    
+    // Reorders every column by arrival time, keeping insertion order on ties.
+    // A borrowed store is copied into owned columns first, unless it is
+    // already in order.
+    void sortByArrival();
+    
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    
+    int taskId(size_t i) const { return id_col[i]; }
+    SimTime arrivalTime(size_t i) const { return arrival_col[i]; }
+    SimTime burstTime(size_t i) const { return burst_col[i]; }
+    int priority(size_t i) const { return priority_col[i]; }
+    
+    SimTime remainingTime(size_t i) const { return remaining[i]; }
+    SimTime startTime(size_t i) const { return starts[i]; }
+    SimTime completionTime(size_t i) const { return completions[i]; }
+    SimTime& remainingTime(size_t i) { return remaining[i]; }
+    SimTime& startTime(size_t i) { return starts[i]; }
+    SimTime& completionTime(size_t i) { return completions[i]; }
+    
+    const int* idData() const { return id_col; }
+    const SimTime* arrivalData() const { return arrival_col; }
+    const SimTime* burstData() const { return burst_col; }
+    const int* priorityData() const { return priority_col; }
+    const SimTime* remainingData() const { return remaining.data(); }
+    const SimTime* startData() const { return starts.data(); }
+    const SimTime* completionData() const { return completions.data(); }
+    
+    // Replaces the output columns with size() values each, e.g. from a
+    // snapshot
+    void restoreOutputs(const SimTime* remaining_column, const SimTime* start_column,
+                        const SimTime* completion_column);
+};
+
+#endif
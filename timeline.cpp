@@ -0,0 +1,34 @@
+#include "timeline.h"
+#include <cstdio>
+#include <stdexcept>
+
+void Timeline::clear() {
+    slices.clear();
+    last_slice.clear();
+}
+
+void writeChromeTrace(const Timeline& timeline, const std::string& path) {
+    std::FILE* out = std::fopen(path.c_str(), "w");
+    if (!out) throw std::runtime_error("cannot create " + path);
+    std::setvbuf(out, nullptr, _IOFBF, 1 << 20);
+
+    std::fprintf(out, "{\"traceEvents\":[\n");
+    std::fprintf(out, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,"
+                      "\"args\":{\"name\":\"Scheduler\"}}");
+    for (int cpu = 0; cpu < timeline.cpus(); cpu++) {
+        std::fprintf(out, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+                          "\"args\":{\"name\":\"CPU%d\"}}", cpu, cpu);
+    }
+    for (size_t i = 0; i < timeline.size(); i++) {
+        const TimelineSlice& s = timeline[i];
+        std::fprintf(out, ",\n{\"name\":\"T%d\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,"
+                          "\"ts\":%lld,\"dur\":%lld}",
+                     s.task_id, s.cpu, (long long)s.start, (long long)(s.end - s.start));
+    }
+    std::fprintf(out, "\n]}\n");
+
+    bool failed = std::ferror(out) != 0;
+    if (std::fclose(out) != 0 || failed) {
+        throw std::runtime_error("write failed: " + path);
+    }
+}
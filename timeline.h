@@ -0,0 +1,65 @@
+#ifndef TIMELINE_H
+#define TIMELINE_H
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include "task_store.h"
+
+// Timeline recording is compiled in with -DSCHED_TIMELINE=1 (make
+// TIMELINE=1). Otherwise the recording branches in the simulators are
+// constant-false and the compiler drops them.
+#ifndef SCHED_TIMELINE
+#define SCHED_TIMELINE 0
+#endif
+
+inline bool timelineEnabled() { return SCHED_TIMELINE != 0; }
+
+// One stretch of a task running on a CPU, [start, end)
+struct TimelineSlice {
+    int task_id;
+    int cpu;
+    SimTime start;
+    SimTime end;
+};
+
+// Which task ran when, on which CPU. Back-to-back slices of the same task
+// on the same CPU are merged, so a task split only by arrivals or by RR
+// quanta with nothing else ready takes one entry.
+class Timeline {
+private:
+    std::vector<TimelineSlice> slices;
+    std::vector<size_t> last_slice;   // per CPU, index of its latest slice + 1
+
+public:
+    explicit Timeline(size_t capacity = 0) { slices.reserve(capacity); }
+
+    void reserve(size_t capacity) { slices.reserve(capacity); }
+    void clear();
+
+    void record(int task_id, int cpu, SimTime start, SimTime end) {
+        if (end <= start) return;
+        if ((size_t)cpu >= last_slice.size()) last_slice.resize(cpu + 1, 0);
+
+        size_t last = last_slice[cpu];
+        if (last && slices[last - 1].task_id == task_id && slices[last - 1].end == start) {
+            slices[last - 1].end = end;
+            return;
+        }
+        TimelineSlice s = { task_id, cpu, start, end };
+        slices.push_back(s);
+        last_slice[cpu] = slices.size();
+    }
+
+    size_t size() const { return slices.size(); }
+    bool empty() const { return slices.empty(); }
+    int cpus() const { return last_slice.size(); }
+    const TimelineSlice& operator[](size_t i) const { return slices[i]; }
+};
+
+// Writes the timeline as Chrome trace-event JSON, loadable in
+// chrome://tracing and Perfetto. One time unit is shown as one microsecond
+// and each CPU as a thread. Throws std::runtime_error on I/O failure.
+void writeChromeTrace(const Timeline& timeline, const std::string& path);
+
+#endif
@@ -0,0 +1,27 @@
+#include "binary_trace.h"
+#include "trace_loader.h"
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+// Converts a text trace to the binary format:
+//   ./trace_convert input.csv output.bin [--delta]
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "usage: " << argv[0] << " input.csv output.bin [--delta]\n";
+        return 2;
+    }
+    bool delta = argc > 3 && std::string(argv[3]) == "--delta";
+    
+    try {
+        TaskStore store;
+        TraceLoadStats stats = loadTrace(argv[1], store);
+        writeBinaryTrace(argv[2], store, delta);
+        std::cout << "Converted " << stats.tasks << " tasks from " << argv[1]
+                  << " to " << argv[2] << (delta ? " (delta arrivals)" : "") << "\n";
+    } catch (const std::runtime_error& e) {
+        std::cerr << "error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
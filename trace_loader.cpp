@@ -0,0 +1,135 @@
+#include "trace_loader.h"
+#include "mapped_file.h"
+#include "binary_trace.h"
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+bool isSeparator(char c) {
+    return c == ',' || c == '\t' || c == ' ' || c == ';';
+}
+
+// Parses a signed decimal integer at p, skipping leading separators. It
+// must end at a separator or the end of the line, so "2.5" or "4x" fails.
+// Clears `fits` for one outside 64 bits.
+bool parseInt(const char*& p, const char* end, long long& value, bool& fits) {
+    while (p < end && isSeparator(*p)) p++;
+    
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        p++;
+    }
+    
+    const char* digits = p;
+    long long v = 0;
+    while (p < end && static_cast<unsigned>(*p - '0') < 10) {
+        int d = *p - '0';
+        if (v > (std::numeric_limits<long long>::max() - d) / 10) fits = false;
+        else v = v * 10 + d;
+        p++;
+    }
+    if (p == digits) return false;
+    if (p < end && !isSeparator(*p) && *p != '\r') return false;
+    
+    value = negative ? -v : v;
+    return true;
+}
+
+size_t countLines(const char* p, const char* end) {
+    size_t lines = 0;
+    while (p < end) {
+        const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        lines++;
+        if (!nl) break;
+        p = nl + 1;
+    }
+    return lines;
+}
+
+}
+
+TraceLoadStats loadTrace(const std::string& path, TaskStore& store) {
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    
+    std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>(path);
+    const char* p = file->data();
+    const char* end = p + file->size();
+    
+    if (isBinaryTrace(p, file->size())) {
+        if (store.empty()) {
+            return attachBinaryTrace(file, store);
+        }
+        
+        TaskStore mapped;
+        TraceLoadStats stats = attachBinaryTrace(file, mapped);
+        store.reserve(store.size() + mapped.size());
+        for (size_t i = 0; i < mapped.size(); i++) {
+            store.add(mapped.taskId(i), mapped.arrivalTime(i), mapped.burstTime(i),
+                      mapped.priority(i));
+        }
+        stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        return stats;
+    }
+    
+    TraceLoadStats stats;
+    stats.bytes = file->size();
+    store.reserve(store.size() + countLines(p, end));
+    
+    size_t line_no = 0;
+    while (p < end) {
+        const char* eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if (!eol) eol = end;
+        line_no++;
+        
+        const char* q = p;
+        while (q < eol && isSeparator(*q)) q++;
+        bool blank = q == eol || *q == '\r' || *q == '#';
+        bool header = line_no == 1 && !blank &&
+                      *q != '-' && *q != '+' && static_cast<unsigned>(*q - '0') >= 10;
+        
+        if (!blank && !header) {
+            long long id, arrival, burst, priority = 0;
+            bool fits = true;
+            if (!parseInt(q, eol, id, fits) || !parseInt(q, eol, arrival, fits) ||
+                !parseInt(q, eol, burst, fits)) {
+                throw std::runtime_error(path + ":" + std::to_string(line_no) +
+                                         ": expected id, arrival, burst[, priority]");
+            }
+            const char* rest = q;
+            while (rest < eol && isSeparator(*rest)) rest++;
+            if (rest < eol && *rest != '\r' && !parseInt(q, eol, priority, fits)) {
+                throw std::runtime_error(path + ":" + std::to_string(line_no) +
+                                         ": expected id, arrival, burst[, priority]");
+            }
+            while (q < eol && isSeparator(*q)) q++;
+            if (q < eol && *q == '\r') q++;
+            const char* problem = nullptr;
+            if (q != eol) {
+                problem = "unexpected text after the last field";
+            } else if (!fits) {
+                problem = "number out of range";
+            } else if (id < INT_MIN || id > INT_MAX) {
+                problem = "task id out of range";
+            } else if (priority < INT_MIN || priority > INT_MAX) {
+                problem = "priority out of range";
+            } else if (arrival < 0 || burst < 0) {
+                problem = "negative arrival or burst";
+            }
+            if (problem) {
+                throw std::runtime_error(path + ":" + std::to_string(line_no) + ": " + problem);
+            }
+            store.add(static_cast<int>(id), arrival, burst, static_cast<int>(priority));
+            stats.tasks++;
+        }
+        
+        p = eol + 1;
+    }
+    
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    return stats;
+}
@@ -0,0 +1,36 @@
+#ifndef TRACE_LOADER_H
+#define TRACE_LOADER_H
+
+#include <string>
+#include <cstddef>
+#include "task_store.h"
+
+// Throughput figures for one trace load
+struct TraceLoadStats {
+    size_t tasks;
+    size_t bytes;
+    double seconds;
+    
+    TraceLoadStats() : tasks(0), bytes(0), seconds(0) {}
+    
+    double tasksPerSecond() const { return seconds > 0 ? tasks / seconds : 0; }
+    double megabytesPerSecond() const { return seconds > 0 ? bytes / seconds / 1e6 : 0; }
+};
+
+// Memory-maps a trace and appends its rows to the store.
+//
+// Text traces have one "id, arrival, burst[, priority]" row per line,
+// separated by commas, tabs or spaces; blank lines, '#' comments and a
+// leading header row are skipped. The store is reserved once from a newline
+// count, so parsing never reallocates.
+//
+// Binary traces (see binary_trace.h) loaded into an empty store are used in
+// place from the mapping; otherwise their rows are copied in.
+//
+// Throws std::runtime_error if the file can't be mapped or is malformed. A
+// text row is malformed if a field is not a whole number, text follows the
+// last field, its arrival or burst is negative, or its id or priority does
+// not fit an int.
+TraceLoadStats loadTrace(const std::string& path, TaskStore& store);
+
+#endif
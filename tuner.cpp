@@ -0,0 +1,183 @@
+#include "tuner.h"
+#include "simulation.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <thread>
+
+namespace {
+
+// Per-worker state kept for the whole search
+struct TuneWorker {
+    TaskStore scratch;
+    EventSimulator sim;
+    RoundRobinQueue queue;
+    StreamingMetrics stream;
+    std::vector<SimTime> turnaround;
+    
+    TuneWorker(const TaskStore& workload, const std::vector<int>& order)
+        : scratch(workload.view()), sim(scratch), queue(1) {
+        sim.useArrivalOrder(order);
+        turnaround.reserve(workload.size());
+    }
+    
+    TunePoint evaluate(SimTime quantum) {
+        queue.setQuantum(quantum);
+        sim.run(queue);
+        
+        TunePoint point;
+        point.quantum = quantum;
+        stream.clear();
+        stream.record(scratch);
+        point.metrics = stream.summary();
+        
+        turnaround.clear();
+        for (size_t i = 0; i < scratch.size(); i++) {
+            turnaround.push_back(scratch.completionTime(i) - scratch.arrivalTime(i));
+        }
+        point.p99_turnaround = 0;
+        if (!turnaround.empty()) {
+            size_t rank = static_cast<size_t>(std::ceil(0.99 * turnaround.size())) - 1;
+            std::nth_element(turnaround.begin(), turnaround.begin() + rank, turnaround.end());
+            point.p99_turnaround = turnaround[rank];
+        }
+        return point;
+    }
+};
+
+double score(const TunePoint& p, const TuneOptions& options) {
+    return options.objective == TUNE_AVG_WAITING ? p.metrics.avg_waiting : p.p99_turnaround;
+}
+
+bool meetsTarget(const TunePoint& p, const TuneOptions& options) {
+    return options.p99_target <= 0 || p.p99_turnaround <= options.p99_target;
+}
+
+// Whether a beats b: meeting the target first, then the objective, then the
+// smaller quantum
+bool better(const TunePoint& a, const TunePoint& b, const TuneOptions& options) {
+    bool ma = meetsTarget(a, options), mb = meetsTarget(b, options);
+    if (ma != mb) return ma;
+    double sa = score(a, options), sb = score(b, options);
+    if (sa != sb) return sa < sb;
+    return a.quantum < b.quantum;
+}
+
+// Up to `points` distinct quanta across [lo, hi]; geometric on wide brackets
+std::vector<SimTime> spread(SimTime lo, SimTime hi, int points) {
+    std::vector<SimTime> quanta;
+    if (hi - lo + 1 <= points) {
+        for (SimTime q = lo; q <= hi; q++) quanta.push_back(q);
+        return quanta;
+    }
+    
+    bool geometric = hi >= 4 * std::max<SimTime>(lo, 1);
+    for (int i = 0; i < points; i++) {
+        double f = static_cast<double>(i) / (points - 1);
+        double q = geometric ? std::max<SimTime>(lo, 1) * std::pow(static_cast<double>(hi) / std::max<SimTime>(lo, 1), f)
+                             : lo + f * (hi - lo);
+        quanta.push_back(static_cast<SimTime>(std::lround(q)));
+    }
+    std::sort(quanta.begin(), quanta.end());
+    quanta.erase(std::unique(quanta.begin(), quanta.end()), quanta.end());
+    return quanta;
+}
+
+}
+
+TuneResult tuneQuantum(const TaskStore& workload, const TuneOptions& options) {
+    SimTime lo = std::max<SimTime>(options.min_quantum, 1);
+    SimTime hi = std::max(options.max_quantum, lo);
+    int points = std::max(options.points, 3);
+    unsigned threads = options.threads;
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min<unsigned>(threads, points);
+    
+    std::vector<int> order = arrivalOrder(workload);
+    std::vector<std::unique_ptr<TuneWorker> > workers;
+    for (unsigned t = 0; t < threads; t++) {
+        workers.push_back(std::unique_ptr<TuneWorker>(new TuneWorker(workload, order)));
+    }
+    
+    std::map<SimTime, TunePoint> evaluated;
+    for (;;) {
+        std::vector<SimTime> round;
+        std::vector<SimTime> candidates = spread(lo, hi, points);
+        for (size_t i = 0; i < candidates.size(); i++) {
+            if (!evaluated.count(candidates[i])) round.push_back(candidates[i]);
+        }
+        
+        std::vector<TunePoint> results(round.size());
+        std::atomic<size_t> next(0);
+        auto work = [&](TuneWorker* w) {
+            for (size_t i = next++; i < round.size(); i = next++) {
+                results[i] = w->evaluate(round[i]);
+            }
+        };
+        std::vector<std::thread> pool;
+        for (unsigned t = 1; t < threads; t++) pool.push_back(std::thread(work, workers[t].get()));
+        work(workers[0].get());
+        for (size_t t = 0; t < pool.size(); t++) pool[t].join();
+        
+        for (size_t i = 0; i < results.size(); i++) evaluated[results[i].quantum] = results[i];
+        if (hi - lo + 1 <= points) break;
+        
+        // Narrow to the neighbours of the best quantum in this bracket
+        std::map<SimTime, TunePoint>::iterator best = evaluated.lower_bound(lo);
+        for (std::map<SimTime, TunePoint>::iterator it = best; it != evaluated.end() && it->first <= hi; ++it) {
+            if (better(it->second, best->second, options)) best = it;
+        }
+        std::map<SimTime, TunePoint>::iterator left = best, right = best;
+        SimTime new_lo = best == evaluated.begin() || (--left)->first < lo ? lo : left->first;
+        ++right;
+        SimTime new_hi = right == evaluated.end() || right->first > hi ? hi : right->first;
+        if (new_lo == lo && new_hi == hi) {
+            // Too few distinct samples to shrink; halve around the best instead
+            SimTime q = best->first, half = (hi - lo) / 4;
+            new_lo = std::max(lo, q - half);
+            new_hi = std::min(hi, q + half);
+        }
+        lo = new_lo;
+        hi = new_hi;
+    }
+    
+    TuneResult result;
+    for (std::map<SimTime, TunePoint>::iterator it = evaluated.begin(); it != evaluated.end(); ++it) {
+        result.curve.push_back(it->second);
+        if (result.curve.size() == 1 || better(it->second, result.best, options)) {
+            result.best = it->second;
+        }
+    }
+    result.target_met = meetsTarget(result.best, options);
+    return result;
+}
+
+void printTuning(const TuneResult& result, const TuneOptions& options) {
+    std::ios::fmtflags flags = std::cout.flags();
+    std::streamsize precision = std::cout.precision();
+    std::cout << std::fixed << std::setprecision(2);
+    
+    std::cout << "\n=== RR Quantum Tuning ("
+              << (options.objective == TUNE_AVG_WAITING ? "average waiting" : "p99 turnaround")
+              << ") ===\n";
+    std::cout << "Quantum\tAvg Waiting\tAvg Turnaround\tP99 Turnaround\n";
+    std::cout << "--------------------------------------------------------\n";
+    for (size_t i = 0; i < result.curve.size(); i++) {
+        const TunePoint& p = result.curve[i];
+        std::cout << p.quantum << "\t" << p.metrics.avg_waiting << "\t"
+                  << p.metrics.avg_turnaround << "\t" << p.p99_turnaround
+                  << (p.quantum == result.best.quantum ? "\t<- best" : "") << "\n";
+    }
+    
+    std::cout << "\nBest Quantum: " << result.best.quantum << "\n";
+    if (options.p99_target > 0) {
+        std::cout << "P99 Target " << options.p99_target
+                  << (result.target_met ? ": met\n" : ": not met by any quantum\n");
+    }
+    
+    std::cout.flags(flags);
+    std::cout.precision(precision);
+}
@@ -0,0 +1,51 @@
+#ifndef TUNER_H
+#define TUNER_H
+
+#include <vector>
+#include "task_store.h"
+#include "metrics.h"
+
+enum TuneObjective {
+    TUNE_AVG_WAITING,      // minimise average waiting time
+    TUNE_P99_TURNAROUND    // minimise 99th-percentile turnaround time
+};
+
+struct TuneOptions {
+    SimTime min_quantum;
+    SimTime max_quantum;
+    TuneObjective objective;
+    double p99_target;      // > 0: only quanta meeting this p99 turnaround can win
+    int points;             // quanta evaluated per refinement round
+    unsigned threads;       // 0 = one per hardware thread
+    
+    TuneOptions()
+        : min_quantum(1), max_quantum(1024), objective(TUNE_AVG_WAITING),
+          p99_target(0), points(8), threads(0) {}
+};
+
+struct TunePoint {
+    SimTime quantum;
+    ScheduleMetrics metrics;
+    double p99_turnaround;
+};
+
+struct TuneResult {
+    TunePoint best;
+    bool target_met;
+    std::vector<TunePoint> curve;   // every quantum evaluated, by quantum
+};
+
+// Searches the RR quantum space coarse-to-fine: each round simulates
+// `points` quanta spread over the current bracket in parallel, then narrows
+// the bracket to the neighbours of the best one, until every integer quantum
+// in it has been tried. Workers keep one view of the workload, one simulator
+// and the shared arrival order for the whole search, and no quantum is
+// simulated twice. Each quantum is still a full run from time 0: two quanta
+// agree only until the smaller one first cuts a slice short, and resuming
+// from there would need a checkpoint of every run. Throws
+// std::invalid_argument if the RR queue rejects a quantum.
+TuneResult tuneQuantum(const TaskStore& workload, const TuneOptions& options);
+
+void printTuning(const TuneResult& result, const TuneOptions& options);
+
+#endif
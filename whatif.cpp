@@ -0,0 +1,193 @@
+#include "whatif.h"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+struct BaselineRun {
+    EventSimulator& sim;
+    template <class Queue> void operator()(Queue& queue) { sim.run(queue); }
+};
+
+// From a checkpoint when there is one, otherwise from the start
+struct Rerun {
+    EventSimulator& sim;
+    const Checkpoint* from;
+    const TaskStore& prior;
+    template <class Queue> void operator()(Queue& queue) {
+        if (from) {
+            sim.rerun(queue, *from, prior);
+        } else {
+            sim.run(queue);
+        }
+    }
+};
+
+}
+
+WhatIfSimulator::WhatIfSimulator(const TaskStore& workload, const std::string& algo,
+                                 SimTime quantum, SimTime every)
+    : base(workload.view()), edited(workload.view()), algorithm(algo), interval(every),
+      queues(algo, quantum), base_dispatches(0), engine(edited) {
+    if (!makeReadyQueue(algorithm, quantum)) {
+        throw std::invalid_argument("unknown algorithm: " + algorithm);
+    }
+
+    arrivalOrder(base, base_order);
+    order = base_order;
+    position.resize(base_order.size());
+    for (size_t i = 0; i < base_order.size(); i++) position[base_order[i]] = i;
+    if (interval <= 0) {
+        SimTime last = base.empty() ? 0 : base.arrivalTime(base_order.back());
+        interval = std::max<SimTime>(1, last / 256);
+    }
+
+    EventSimulator sim(base);
+    sim.useArrivalOrder(base_order);
+    sim.checkpointEvery(interval, &checkpoints);
+    BaselineRun run = { sim };
+    visitReadyQueue(queues, algorithm, run);
+    base_dispatches = sim.dispatches();
+
+    engine.useArrivalOrder(order);
+    engine.checkpointEvery(interval, nullptr);
+}
+
+// Moves the edited tasks to their new arrival times in `order`. Only the
+// span [lo, hi) between their old and new places changes; it is rebuilt
+// from base_order, and the rest of `order` still matches it.
+void WhatIfSimulator::reorder(size_t& lo, size_t& hi) {
+    const TaskStore& before = base;
+    const TaskStore& after = edited;
+    lo = base_order.size();
+    hi = 0;
+    for (size_t i = 0; i < changed.size(); i++) {
+        int job = changed[i];
+        SimTime arrival = after.arrivalTime(job);
+        auto earlier = [&before, arrival](int other, int j) {
+            SimTime t = before.arrivalTime(other);
+            return t < arrival || (t == arrival && other < j);
+        };
+        size_t to = std::lower_bound(base_order.begin(), base_order.end(), job, earlier) -
+                    base_order.begin();
+        lo = std::min(lo, std::min(position[job], to));
+        hi = std::max(hi, std::max(position[job] + 1, to));
+    }
+
+    auto earlier = [&after](int a, int b) {
+        SimTime ta = after.arrivalTime(a), tb = after.arrivalTime(b);
+        return ta < tb || (ta == tb && a < b);
+    };
+    std::vector<int> moved(changed);
+    std::sort(moved.begin(), moved.end(), earlier);
+    size_t out = lo, next = 0;
+    for (size_t i = lo; i < hi; i++) {
+        int job = base_order[i];
+        if (std::binary_search(changed.begin(), changed.end(), job)) continue;
+        while (next < moved.size() && earlier(moved[next], job)) order[out++] = moved[next++];
+        order[out++] = job;
+    }
+    while (next < moved.size()) order[out++] = moved[next++];
+}
+
+int WhatIfResult::find(int i) const {
+    std::vector<int>::const_iterator it = std::lower_bound(rows.begin(), rows.end(), i);
+    return it != rows.end() && *it == i ? it - rows.begin() : -1;
+}
+
+TaskStore WhatIfResult::apply(const TaskStore& baseline) const {
+    TaskStore full(baseline);
+    for (size_t k = 0; k < rows.size(); k++) {
+        int job = rows[k];
+        full.setInputs(job, changes.arrivalTime(k), changes.burstTime(k), changes.priority(k));
+        full.remainingTime(job) = changes.remainingTime(k);
+        full.startTime(job) = changes.startTime(k);
+        full.completionTime(job) = changes.completionTime(k);
+    }
+    return full;
+}
+
+WhatIfResult WhatIfSimulator::query(const std::vector<TaskEdit>& edits) {
+    WhatIfResult result;
+    if (edits.empty()) {
+        result.dispatches = base_dispatches;
+        return result;
+    }
+
+    SimTime earliest = std::numeric_limits<SimTime>::max();
+    SimTime latest = std::numeric_limits<SimTime>::min();
+    for (size_t i = 0; i < edits.size(); i++) {
+        const TaskEdit& e = edits[i];
+        if (e.index >= base.size()) {
+            throw std::invalid_argument("task index out of range: " + std::to_string(e.index));
+        }
+        SimTime before = base.arrivalTime(e.index);
+        earliest = std::min(earliest, std::min(before, e.arrival));
+        latest = std::max(latest, std::max(before, e.arrival));
+    }
+
+    changed.clear();
+    for (size_t i = 0; i < edits.size(); i++) {
+        const TaskEdit& e = edits[i];
+        edited.setInputs(e.index, e.arrival, e.burst, e.priority);
+        changed.push_back(e.index);
+    }
+    std::sort(changed.begin(), changed.end());
+    changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+    size_t lo, hi;
+    reorder(lo, hi);
+
+    // The last checkpoint before anything the edits touch
+    std::vector<Checkpoint>::const_iterator after = std::lower_bound(
+        checkpoints.begin(), checkpoints.end(), earliest,
+        [](const Checkpoint& c, SimTime t) { return c.time < t; });
+    const Checkpoint* from = after == checkpoints.begin() ? nullptr : &*(after - 1);
+
+    engine.convergeTo(&checkpoints, latest, &changed);
+    Rerun rerun = { engine, from, base };
+    visitReadyQueue(queues, algorithm, rerun);
+
+    result.dispatches = engine.dispatches();
+    result.restarted = from ? from->time : -1;
+    const Checkpoint* met = engine.converged();
+    if (met) {
+        result.rejoined = met->time;
+        result.dispatches += base_dispatches - met->dispatches;
+    }
+
+    // Only the jobs in the system at the restart, and those arriving before
+    // the rejoin, were simulated. Those still unfinished at the rejoin go on
+    // exactly as in the baseline.
+    std::vector<int>& rows = result.rows;
+    if (from) rows.assign(from->active.begin(), from->active.end());
+    size_t first = from ? from->next_arrival : 0;
+    size_t last = met ? met->next_arrival : order.size();
+    rows.insert(rows.end(), order.begin() + first, order.begin() + last);
+    std::sort(rows.begin(), rows.end());
+    size_t kept = 0;
+    for (size_t k = 0; k < rows.size(); k++) {
+        int job = rows[k];
+        bool differs = std::binary_search(changed.begin(), changed.end(), job);
+        if (!differs && !(met && base.completionTime(job) > met->time)) {
+            differs = edited.startTime(job) != base.startTime(job) ||
+                      edited.completionTime(job) != base.completionTime(job);
+        }
+        if (!differs) continue;
+        rows[kept++] = job;
+        size_t row = result.changes.size();
+        result.changes.add(edited.taskId(job), edited.arrivalTime(job), edited.burstTime(job),
+                           edited.priority(job));
+        result.changes.remainingTime(row) = edited.remainingTime(job);
+        result.changes.startTime(row) = edited.startTime(job);
+        result.changes.completionTime(row) = edited.completionTime(job);
+    }
+    rows.resize(kept);
+
+    for (size_t i = 0; i < changed.size(); i++) {
+        int job = changed[i];
+        edited.setInputs(job, base.arrivalTime(job), base.burstTime(job), base.priority(job));
+    }
+    std::copy(base_order.begin() + lo, base_order.begin() + hi, order.begin() + lo);
+    return result;
+}
@@ -0,0 +1,83 @@
+#ifndef WHATIF_H
+#define WHATIF_H
+
+#include <string>
+#include <vector>
+#include "simulation.h"
+
+// New inputs for one task in a what-if query
+struct TaskEdit {
+    size_t index;     // store index of the task
+    SimTime arrival;
+    SimTime burst;
+    int priority;
+
+    TaskEdit(size_t i, SimTime a, SimTime b, int p = 0)
+        : index(i), arrival(a), burst(b), priority(p) {}
+};
+
+// A query's schedule as the tasks that differ from the baseline, in inputs
+// or in start or completion time. Every other task runs as in
+// WhatIfSimulator::baseline().
+struct WhatIfResult {
+    std::vector<int> rows;      // store indices of those tasks, ascending
+    TaskStore changes;    // row k: task rows[k]'s inputs and times
+    size_t dispatches;
+    SimTime restarted;    // checkpoint the rerun began from, -1 for the start
+    SimTime rejoined;     // checkpoint where it met the baseline again, -1 if never
+
+    WhatIfResult() : dispatches(0), restarted(-1), rejoined(-1) {}
+
+    // Row of task i in `changes`, or -1 if it is as in the baseline
+    int find(int i) const;
+    // The whole schedule: the baseline with the changed rows written over it
+    TaskStore apply(const TaskStore& baseline) const;
+};
+
+// Answers "what if these tasks arrived at other times, or had other bursts
+// or priorities?" without rerunning the whole schedule. The baseline run
+// keeps a Checkpoint every `interval` time units. A change cannot affect
+// the schedule before the earlier of an edited task's old and new arrival,
+// so a query restarts from the last checkpoint before that. It stops at the
+// first later checkpoint where every edited task has finished and the state
+// matches the baseline's again, and takes the rest of the schedule from the
+// baseline. Single CPU only.
+class WhatIfSimulator {
+private:
+    TaskStore base;        // baseline outputs
+    TaskStore edited;      // inputs with a query's edits applied
+    std::string algorithm;
+    SimTime interval;
+    ReadyQueueSet queues;
+    std::vector<int> base_order;
+    std::vector<int> order;          // base_order with a query's moves applied
+    std::vector<size_t> position;    // of each task in base_order
+    std::vector<Checkpoint> checkpoints;
+    size_t base_dispatches;
+    EventSimulator engine;
+    std::vector<int> changed;
+
+    void reorder(size_t& lo, size_t& hi);
+
+public:
+    // Runs the baseline over the workload's input columns in place, so the
+    // workload must outlive the simulator. An interval of 0 spreads about
+    // 256 checkpoints over the arrivals. Throws std::invalid_argument for
+    // an unknown algorithm.
+    WhatIfSimulator(const TaskStore& workload, const std::string& algorithm,
+                    SimTime quantum = 4, SimTime interval = 0);
+
+    const TaskStore& baseline() const { return base; }
+    size_t baselineDispatches() const { return base_dispatches; }
+    size_t checkpointCount() const { return checkpoints.size(); }
+    SimTime checkpointInterval() const { return interval; }
+
+    // The schedule with `edits` applied to the baseline inputs, exactly as
+    // a full run over them would produce it. Only the tasks the rerun
+    // touched are compared with the baseline, and only those that differ
+    // are returned. Throws std::invalid_argument for a task index out of
+    // range.
+    WhatIfResult query(const std::vector<TaskEdit>& edits);
+};
+
+#endif
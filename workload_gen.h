@@ -0,0 +1,46 @@
+#ifndef WORKLOAD_GEN_H
+#define WORKLOAD_GEN_H
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include "task_store.h"
+
+enum BurstDistribution {
+    BURST_EXPONENTIAL,
+    BURST_BIMODAL,      // 90% short jobs, 10% jobs ten times longer
+    BURST_PARETO        // heavy tail, shape 1.5
+};
+
+enum PriorityDistribution {
+    PRIORITY_UNIFORM,
+    PRIORITY_SKEWED     // geometric: most tasks at the highest priority
+};
+
+// Synthetic workload description. Arrivals are a Poisson process whose
+// rate gives the requested offered load on one CPU.
+struct WorkloadSpec {
+    size_t tasks;
+    double mean_burst;
+    double load;              // mean_burst / mean interarrival time
+    BurstDistribution burst;
+    PriorityDistribution priority;
+    int priority_levels;
+    uint64_t seed;
+    
+    WorkloadSpec()
+        : tasks(1000), mean_burst(10), load(0.9), burst(BURST_EXPONENTIAL),
+          priority(PRIORITY_UNIFORM), priority_levels(8), seed(1) {}
+};
+
+// Replaces the store's contents with a workload drawn from the spec. The
+// same spec and seed always give the same tasks.
+void generateWorkload(const WorkloadSpec& spec, TaskStore& store);
+
+// Short label such as "exponential/uniform" for reports
+std::string describeWorkload(const WorkloadSpec& spec);
+
+// Parses "exponential", "bimodal" or "pareto"; false if the name is unknown
+bool parseBurstDistribution(const std::string& name, BurstDistribution& burst);
+
+#endif